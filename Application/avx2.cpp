@@ -0,0 +1,8 @@
+#include "stepping.hpp"
+
+#if !defined(__AVX2__)
+#error "Avx2.cpp must be compiled with /arch:AVX2"
+#endif
+
+
+const kernels::Table kernels::AVX2 = stepping::MakeTable<simd::Pack<simd::Avx2F64>, simd::Pack<simd::Avx2F32>>(kernels::Level::AVX2);
@@ -0,0 +1,8 @@
+#include "stepping.hpp"
+
+#if !defined(__AVX512F__)
+#error "Avx512.cpp must be compiled with /arch:AVX512"
+#endif
+
+
+const kernels::Table kernels::AVX512 = stepping::MakeTable<simd::Pack<simd::Avx512F64>, simd::Pack<simd::Avx512F32>>(kernels::Level::AVX512);
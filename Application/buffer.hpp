@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+// Lock-free single writer, single reader latest-value handoff
+template <class T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : m_Buffers{}, m_Back{ 0 }, m_Middle{ 1 }, m_Front{ 2 }
+	{
+	}
+
+	// Writer side
+	T& Back()
+	{
+		return m_Buffers[m_Back];
+	}
+
+	void Publish()
+	{
+		m_Back = m_Middle.exchange(m_Back | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// Reader side
+	bool Update()
+	{
+		if ((m_Middle.load(std::memory_order_relaxed) & FRESH) == 0)
+			return false;
+
+		m_Front = m_Middle.exchange(m_Front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	const T& Front() const
+	{
+		return m_Buffers[m_Front];
+	}
+
+private:
+	static constexpr uint8_t INDEX = 0x3;
+	static constexpr uint8_t FRESH = 0x4;
+
+	T m_Buffers[3];
+	alignas(64) uint8_t m_Back;
+	alignas(64) std::atomic<uint8_t> m_Middle;
+	alignas(64) uint8_t m_Front;
+};
@@ -0,0 +1,286 @@
+#include "chain.hpp"
+
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+
+
+Chain::Chain()
+	: Chain(
+		std::vector<double>(std::begin(cfg::chain::MASS), std::end(cfg::chain::MASS)),
+		std::vector<double>(std::begin(cfg::chain::LENGTH), std::end(cfg::chain::LENGTH)),
+		std::vector<double>(std::begin(cfg::chain::FRICTION), std::end(cfg::chain::FRICTION)))
+{
+}
+
+Chain::Chain(const std::vector<double>& mass,
+			 const std::vector<double>& length,
+			 const std::vector<double>& friction)
+	: m_Mass{ mass }, m_Length{ length }, m_Friction{ friction }
+{
+	const size_t n = m_Mass.size();
+
+	if (m_Length.size() != n || m_Friction.size() != n)
+		throw std::invalid_argument("Chain parameters must have one entry per link.");
+
+	m_Pos.assign(n, 0.0);
+	m_Vel.assign(n, 0.0);
+	m_Acc.assign(n, 0.0);
+	m_X.resize(n);
+	m_IA.resize(n);
+	m_V.resize(n);
+	m_C.resize(n);
+	m_PA.resize(n);
+	m_U.resize(n);
+	m_A.resize(n);
+	m_D.resize(n);
+	m_Tau.resize(n);
+	m_State.resize(2 * n);
+	m_Stage.resize(2 * n);
+
+	for (std::vector<double>& k : m_K)
+		k.resize(2 * n);
+}
+
+Chain Chain::Rope(const int links, const double mass, const double length, const double friction)
+{
+	return Chain(
+		std::vector<double>(links, mass / links),
+		std::vector<double>(links, length / links),
+		std::vector<double>(links, friction)
+	);
+}
+
+void Chain::Update(const double dt)
+{
+	const size_t n = m_Mass.size();
+
+	for (size_t i = 0; i < n; i++)
+	{
+		m_State[i] = m_Pos[i];
+		m_State[n + i] = m_Vel[i];
+	}
+
+	// Classic fourth-order Runge-Kutta over the whole chain
+	Derivative(m_State, m_K[0]);
+
+	for (size_t j = 0; j < 2 * n; j++)
+		m_Stage[j] = m_State[j] + 0.5 * dt * m_K[0][j];
+
+	Derivative(m_Stage, m_K[1]);
+
+	for (size_t j = 0; j < 2 * n; j++)
+		m_Stage[j] = m_State[j] + 0.5 * dt * m_K[1][j];
+
+	Derivative(m_Stage, m_K[2]);
+
+	for (size_t j = 0; j < 2 * n; j++)
+		m_Stage[j] = m_State[j] + dt * m_K[2][j];
+
+	Derivative(m_Stage, m_K[3]);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		const size_t j = n + i;
+		m_Pos[i] += dt / 6 * (m_K[0][i] + 2 * m_K[1][i] + 2 * m_K[2][i] + m_K[3][i]);
+		m_Vel[i] += dt / 6 * (m_K[0][j] + 2 * m_K[1][j] + 2 * m_K[2][j] + m_K[3][j]);
+		m_Acc[i] = m_K[0][j];
+	}
+}
+
+void Chain::Restart()
+{
+	std::fill(m_Pos.begin(), m_Pos.end(), 0.0);
+	std::fill(m_Vel.begin(), m_Vel.end(), 0.0);
+	std::fill(m_Acc.begin(), m_Acc.end(), 0.0);
+}
+
+void Chain::Derivative(const std::vector<double>& x, std::vector<double>& dx)
+{
+	const size_t n = m_Mass.size();
+
+	Accelerations(x.data(), x.data() + n, dx.data() + n);
+
+	for (size_t i = 0; i < n; i++)
+		dx[i] = x[n + i];
+}
+
+// Featherstone's articulated body algorithm, O(n) in the number of links
+void Chain::Accelerations(const double* q, const double* w, double* a)
+{
+	const size_t n = m_Mass.size();
+
+	// Outward pass: link transforms, velocities, bias terms and rigid body inertias
+	for (size_t i = 0; i < n; i++)
+	{
+		const double c = cos(q[i]);
+		const double s = sin(q[i]);
+		const double r = i == 0 ? 0.0 : m_Length[i - 1];
+
+		// Parent to link motion transform for a joint at (r, 0) in the parent frame
+		m_X[i] = Mat3
+		{
+			Vec3{ 1.0, 0.0, 0.0 },
+			Vec3{ s * r, c, s },
+			Vec3{ c * r, -s, c }
+		};
+
+		Vec3 v{ w[i], 0.0, 0.0 };
+
+		if (i > 0)
+		{
+			const Vec3& p = m_V[i - 1];
+			v[0] += p[0];
+			v[1] += m_X[i][1][0] * p[0] + c * p[1] + s * p[2];
+			v[2] += m_X[i][2][0] * p[0] - s * p[1] + c * p[2];
+		}
+
+		m_V[i] = v;
+		m_C[i] = Vec3{ 0.0, v[2] * w[i], -v[1] * w[i] };
+
+		// Point mass at (L, 0) in the link frame
+		const double m = m_Mass[i];
+		const double L = m_Length[i];
+		m_IA[i] = Mat3
+		{
+			Vec3{ m * L * L, 0.0, m * L },
+			Vec3{ 0.0, m, 0.0 },
+			Vec3{ m * L, 0.0, m }
+		};
+
+		// Velocity product force v x* (I v)
+		const Vec3 h{ m * L * (L * v[0] + v[2]), m * v[1], m * (L * v[0] + v[2]) };
+		m_PA[i] = Vec3{ -v[2] * h[1] + v[1] * h[2], -v[0] * h[2], v[0] * h[1] };
+		m_Tau[i] = -m_Friction[i] * w[i];
+	}
+
+	// Inward pass: articulated inertias and bias forces
+	for (size_t i = n; i-- > 0;)
+	{
+		const Mat3& IA = m_IA[i];
+		const Vec3 U{ IA[0][0], IA[1][0], IA[2][0] };
+		const double d = U[0];
+		const double u = m_Tau[i] - m_PA[i][0];
+
+		m_U[i] = U;
+		m_D[i] = d;
+		m_Tau[i] = u;
+
+		if (i == 0)
+			continue;
+
+		Mat3 Ia;
+		Vec3 pa;
+
+		for (int r = 0; r < 3; r++)
+		{
+			for (int k = 0; k < 3; k++)
+				Ia[r][k] = IA[r][k] - U[r] * U[k] / d;
+		}
+
+		for (int r = 0; r < 3; r++)
+			pa[r] = m_PA[i][r] + Ia[r][0] * m_C[i][0] + Ia[r][1] * m_C[i][1] + Ia[r][2] * m_C[i][2] + U[r] * u / d;
+
+		// Transform into the parent frame, I += X^T Ia X and p += X^T pa
+		const Mat3& X = m_X[i];
+		Mat3 IaX;
+
+		for (int r = 0; r < 3; r++)
+		{
+			for (int k = 0; k < 3; k++)
+				IaX[r][k] = Ia[r][0] * X[0][k] + Ia[r][1] * X[1][k] + Ia[r][2] * X[2][k];
+		}
+
+		Mat3& parent = m_IA[i - 1];
+
+		for (int r = 0; r < 3; r++)
+		{
+			for (int k = 0; k < 3; k++)
+				parent[r][k] += X[0][r] * IaX[0][k] + X[1][r] * IaX[1][k] + X[2][r] * IaX[2][k];
+
+			m_PA[i - 1][r] += X[0][r] * pa[0] + X[1][r] * pa[1] + X[2][r] * pa[2];
+		}
+	}
+
+	// Outward pass: joint and link accelerations, gravity as a base acceleration
+	Vec3 parent{ 0.0, 0.0, cfg::env::GRAVITY };
+
+	for (size_t i = 0; i < n; i++)
+	{
+		const Mat3& X = m_X[i];
+		Vec3 ap;
+
+		for (int r = 0; r < 3; r++)
+			ap[r] = X[r][0] * parent[0] + X[r][1] * parent[1] + X[r][2] * parent[2] + m_C[i][r];
+
+		const Vec3& U = m_U[i];
+		a[i] = (m_Tau[i] - U[0] * ap[0] - U[1] * ap[1] - U[2] * ap[2]) / m_D[i];
+
+		ap[0] += a[i];
+		m_A[i] = ap;
+		parent = ap;
+	}
+}
+
+size_t Chain::GetSize() const
+{
+	return m_Mass.size();
+}
+
+double Chain::GetLength(const size_t i) const
+{
+	return m_Length[i];
+}
+
+void Chain::GetLinkFrames(std::vector<Coord>& frames) const
+{
+	frames.resize(m_Pos.size());
+
+	double x = 0.0;
+	double y = 0.0;
+	double angle = 0.0;
+
+	for (size_t i = 0; i < m_Pos.size(); i++)
+	{
+		angle += m_Pos[i];
+		const double c = cos(angle);
+		const double s = sin(angle);
+
+		frames[i] = Coord{ x + m_Length[i] / 2 * c, y + m_Length[i] / 2 * s };
+		x += m_Length[i] * c;
+		y += m_Length[i] * s;
+	}
+}
+
+void Chain::GetJointFrames(std::vector<Coord>& frames) const
+{
+	frames.resize(m_Pos.size());
+
+	double x = 0.0;
+	double y = 0.0;
+	double angle = 0.0;
+
+	for (size_t i = 0; i < m_Pos.size(); i++)
+	{
+		frames[i] = Coord{ x, y };
+		angle += m_Pos[i];
+		x += m_Length[i] * cos(angle);
+		y += m_Length[i] * sin(angle);
+	}
+}
+
+const std::vector<double>& Chain::GetPositions() const
+{
+	return m_Pos;
+}
+
+const std::vector<double>& Chain::GetVelocities() const
+{
+	return m_Vel;
+}
+
+const std::vector<double>& Chain::GetAccelerations() const
+{
+	return m_Acc;
+}
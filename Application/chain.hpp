@@ -0,0 +1,61 @@
+#pragma once
+
+#include "robot.hpp"
+#include "config.hpp"
+
+#include <vector>
+
+
+// Planar chain of N revolute joints with a point mass at the end of each link
+class Chain
+{
+public:
+	Chain();
+	Chain(const std::vector<double>& mass,
+		  const std::vector<double>& length,
+		  const std::vector<double>& friction);
+
+	static Chain Rope(const int links, const double mass, const double length, const double friction);
+
+	void Update(const double dt);
+	void Restart();
+
+	void Accelerations(const double* q, const double* w, double* a);
+
+	size_t GetSize() const;
+	double GetLength(const size_t i) const;
+	void GetLinkFrames(std::vector<Coord>& frames) const;
+	void GetJointFrames(std::vector<Coord>& frames) const;
+	const std::vector<double>& GetPositions() const;
+	const std::vector<double>& GetVelocities() const;
+	const std::vector<double>& GetAccelerations() const;
+
+private:
+	// Planar spatial vectors are ordered { angular, linear x, linear y }
+	using Vec3 = std::array<double, 3>;
+	using Mat3 = std::array<Vec3, 3>;
+
+	void Derivative(const std::vector<double>& x, std::vector<double>& dx);
+
+	std::vector<double> m_Mass;
+	std::vector<double> m_Length;
+	std::vector<double> m_Friction;
+
+	std::vector<double> m_Pos;
+	std::vector<double> m_Vel;
+	std::vector<double> m_Acc;
+
+	// Scratch space reused every step so stepping never allocates
+	std::vector<Mat3> m_X;
+	std::vector<Mat3> m_IA;
+	std::vector<Vec3> m_V;
+	std::vector<Vec3> m_C;
+	std::vector<Vec3> m_PA;
+	std::vector<Vec3> m_U;
+	std::vector<Vec3> m_A;
+	std::vector<double> m_D;
+	std::vector<double> m_Tau;
+	std::vector<double> m_State;
+	std::vector<double> m_Stage;
+	std::vector<double> m_K[4];
+};
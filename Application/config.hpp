@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 
 // Application configuration
 namespace cfg
@@ -10,8 +12,10 @@ namespace cfg
 		constexpr int FONT_SIZE = 18;
 		constexpr int DEFAULT_WIDTH = 1280;
 		constexpr int DEFAULT_HEIGHT = 720;
-		constexpr double SIM_TIME = 1e-9;
 		constexpr double INFO_TIME = 1e-1;
+		constexpr double FRAME_RATE = 120.0;
+		constexpr double SPIN_TIME = 1e-3;
+		constexpr bool VSYNC = true;
 	}
 
 	// Colour palette
@@ -45,12 +49,121 @@ namespace cfg
 		constexpr double FRICTION[2] = { 0.05, 0.1 };
 	}
 
+	// Chain parameters, one entry per link
+	namespace chain
+	{
+		constexpr double MASS[3] = { 1.0, 1.0, 1.0 };
+		constexpr double WIDTH[3] = { 0.01, 0.01, 0.01 };
+		constexpr double LENGTH[3] = { 0.1, 0.1, 0.1 };
+		constexpr double RADIUS[3] = { 0.01, 0.01, 0.01 };
+		constexpr double FRICTION[3] = { 0.05, 0.1, 0.1 };
+	}
+
 	// Physics environment
 	namespace env
 	{
 		constexpr double GRAVITY = 9.81;
 	}
 
+	// Physics stepping
+	namespace sim
+	{
+		constexpr double RATE = 1e4;
+		constexpr double LOOP_RATE = 1e3;
+		constexpr int MAX_STEPS = 2000;
+		constexpr double RTOL = 1e-8;
+		constexpr double ATOL = 1e-10;
+		constexpr double MAX_STEP = 0.1;
+		constexpr size_t MAX_FIXED_LINKS = 8;
+	}
+
+	// CPU feature dispatch
+	namespace cpu
+	{
+		// Environment variable forcing a kernel level: sse2, avx2 or avx512
+		constexpr const char* ISA_OVERRIDE = "PENDULUM_ISA";
+	}
+
+	// Worker pool
+	namespace pool
+	{
+		// Ensemble lanes per stolen chunk, a multiple of kernels::BLOCK
+		constexpr size_t CHUNK = 256;
+		// Pin worker i to logical processor i, leaving the calling thread as worker 0 unpinned
+		constexpr bool PIN = false;
+	}
+
+	// Lyapunov spectra
+	namespace lyapunov
+	{
+		// Steps between Gram-Schmidt passes on the tangent vectors
+		constexpr int RENORM = 10;
+		// RK4 step of the lyapunov command and the steps per pool pass, a multiple of RENORM
+		constexpr double STEP = 1e-3;
+		constexpr int BATCH = 1000;
+	}
+
+	// Integrator event detection
+	namespace event
+	{
+		// Dense output samples per step checked for a sign change
+		constexpr int SUBDIVIDE = 4;
+		constexpr double TIME_TOL = 1e-12;
+		constexpr int MAX_ITERATIONS = 60;
+		constexpr int MAX_EVENTS = 8;
+	}
+
+	// Poincare sections
+	namespace section
+	{
+		// Sparsest to densest bins, blended by log count
+		constexpr const int* PALETTE[] = { col::BLUE, col::AQUA, col::GREEN, col::YELLOW, col::WHITE };
+		constexpr auto BACKGROUND = col::GREY;
+	}
+
+	// Flip time map
+	namespace flip
+	{
+		constexpr double STEP = 1e-3;
+		constexpr double MAX_TIME = 10.0;
+		// Steps between flip checks, the resolution of the recorded times
+		constexpr int CHECK = 8;
+		// Tile side in pixels, TILE * TILE a multiple of kernels::BLOCK
+		constexpr int TILE = 16;
+		// Quadtree tile side and coarsest cell in pixels
+		constexpr int QUAD = 64;
+		constexpr int CELL = 8;
+		// Log time buckets a quadtree cell's probe points must share to be interpolated
+		constexpr int BUCKETS = 32;
+		// Tiles per worker between checkpoints
+		constexpr size_t BATCH = 64;
+		constexpr double SAVE_TIME = 60.0;
+		// Quickest to slowest flips, blended by log time
+		constexpr const int* PALETTE[] = { col::WHITE, col::YELLOW, col::RED, col::PURPLE, col::BLUE };
+		constexpr auto NEVER_COLOUR = col::GREY;
+	}
+
+	// Live flip time map
+	namespace explore
+	{
+		// Coarse to fine passes, the first in blocks of 2^(LEVELS - 1) pixels
+		constexpr int LEVELS = 4;
+		constexpr double ZOOM = 1.25;
+		// Pixels a press may move and still count as a click
+		constexpr int CLICK_SLOP = 3;
+		constexpr auto BACKGROUND = col::GREY;
+	}
+
+	// Phase timers
+	namespace prof
+	{
+		// Samples kept per phase and thread, a few seconds of frames
+		constexpr size_t CAPACITY = 1024;
+		// Trace events queued per thread between flushes
+		constexpr size_t TRACE_CAPACITY = 16384;
+		constexpr double FLUSH_TIME = 0.1;
+	}
+
 	// Buffer settings
 	namespace buf
 	{
@@ -0,0 +1,107 @@
+#include "draw.hpp"
+
+#include <array>
+#include <math.h>
+
+
+void SetDrawColour(SDL_Renderer* renderer, const int rgb[3])
+{
+	SDL_SetRenderDrawColor(renderer, rgb[0], rgb[1], rgb[2], SDL_ALPHA_OPAQUE);
+}
+
+void DrawRectangle(SDL_Renderer* renderer, const double x, const double y, const double l, const double w, const double a)
+{
+	int n_points = 0;
+	std::array<SDL_Point, cfg::buf::MAX_OUTLINE_SIZE> outline{};
+
+	int pxl, pyl, pxr, pyr;
+	const double inc = 1 / w;
+	const double cosa = cos(a);
+	const double sina = sin(a);
+	const double w_cosa = w * cosa;
+	const double w_sina = w * sina;
+	const double nw_cosa = -w_cosa;
+	const double nw_sina = -w_sina;
+	const double l_2_cosa = l / 2 * cosa;
+	const double l_2_sina = l / 2 * sina;
+	const double l_2_cosa_px = l_2_cosa + x;
+	const double l_2_sina_py = l_2_sina + y;
+	const double nl_2_cosa_px = -l_2_cosa + x;
+	const double nl_2_sina_py = -l_2_sina + y;
+	SetDrawColour(renderer, cfg::link::COLOUR);
+
+	for (double t = -0.5; t < 0.5; t += inc)
+	{
+		pxl = (int)(l_2_cosa_px + nw_sina * t);
+		pyl = (int)(l_2_sina_py + w_cosa * t);
+		pxr = (int)(nl_2_cosa_px + nw_sina * t);
+		pyr = (int)(nl_2_sina_py + w_cosa * t);
+		outline[n_points++] = SDL_Point{ pxl, pyl };
+		outline[n_points++] = SDL_Point{ pxr, pyr };
+		SDL_RenderDrawLine(renderer, pxl, pyl, pxr, pyr);
+	}
+
+	SetDrawColour(renderer, cfg::col::BLACK);
+	SDL_RenderDrawPoints(renderer, outline.data(), n_points);
+	const double w_2_cosa = w_cosa / 2;
+	const double w_2_sina = w_sina / 2;
+	const double nw_2_cosa = -w_2_cosa;
+	const double nw_2_sina = -w_2_sina;
+	pxl = (int)(l_2_cosa_px + nw_2_sina);
+	pyl = (int)(l_2_sina_py + w_2_cosa);
+	pxr = (int)(nl_2_cosa_px + nw_2_sina);
+	pyr = (int)(nl_2_sina_py + w_2_cosa);
+	SDL_RenderDrawLine(renderer, pxl, pyl, pxr, pyr);
+	pxl = (int)(l_2_cosa_px + w_2_sina);
+	pyl = (int)(l_2_sina_py + nw_2_cosa);
+	pxr = (int)(nl_2_cosa_px + w_2_sina);
+	pyr = (int)(nl_2_sina_py + nw_2_cosa);
+	SDL_RenderDrawLine(renderer, pxl, pyl, pxr, pyr);
+}
+
+void DrawCircle(SDL_Renderer* renderer, const double x, const double y, const double r)
+{
+	int n_points = 0;
+	std::array<SDL_Point, cfg::buf::MAX_OUTLINE_SIZE> outline{};
+
+	const double inc = 1 / r;
+	SetDrawColour(renderer, cfg::joint::COLOUR);
+
+	for (double a = 0.0; a < M_PI; a += inc)
+	{
+		const double rsina = r * sin(a);
+		const int px = (int)(x + r * cos(a));
+		const int py1 = (int)(y + rsina);
+		const int py2 = (int)(y - rsina);
+		outline[n_points++] = SDL_Point{ px, py1 };
+		outline[n_points++] = SDL_Point{ px, py2 };
+		SDL_RenderDrawLine(renderer, px, py1, px, py2);
+	}
+
+	SetDrawColour(renderer, cfg::col::BLACK);
+	SDL_RenderDrawPoints(renderer, outline.data(), n_points);
+}
+
+void DrawText(SDL_Renderer* renderer, TTF_Font* font, const std::vector<std::string>& lines,
+			  std::vector<SDL_Texture*>& textures, std::vector<SDL_Rect>& areas)
+{
+	constexpr auto c = cfg::col::WHITE;
+	constexpr SDL_Color fg{ c[0], c[1], c[2], SDL_ALPHA_OPAQUE };
+
+	for (SDL_Texture* texture : textures)
+		SDL_DestroyTexture(texture);
+
+	textures.clear();
+	areas.clear();
+
+	int y = 0;
+
+	for (const std::string& line : lines)
+	{
+		SDL_Surface* surface = TTF_RenderText_Solid(font, line.c_str(), fg);
+		textures.push_back(SDL_CreateTextureFromSurface(renderer, surface));
+		areas.push_back(SDL_Rect{ 0, y, surface->w, surface->h });
+		y += surface->h;
+		SDL_FreeSurface(surface);
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include <string>
+#include <vector>
+
+
+// Drawing primitives of the window, free of it so they run on any renderer,
+// including an offscreen software one for benchmarks
+
+void SetDrawColour(SDL_Renderer* renderer, const int rgb[3]);
+// Link of length l and width w centred on (x, y) at angle a, filled and outlined
+void DrawRectangle(SDL_Renderer* renderer, const double x, const double y, const double l, const double w, const double a);
+// Joint of radius r centred on (x, y), filled and outlined
+void DrawCircle(SDL_Renderer* renderer, const double x, const double y, const double r);
+// Replace textures with one per line of text, stacked down from the top left into areas
+void DrawText(SDL_Renderer* renderer, TTF_Font* font, const std::vector<std::string>& lines,
+			  std::vector<SDL_Texture*>& textures, std::vector<SDL_Rect>& areas);
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <cmath>
+
+
+// Two-link forward dynamics in manipulator form M(q) a = tau - C(q, w) - G(q)
+namespace dynamics
+{
+	// Parameters folded at compile time
+	constexpr double g = cfg::env::GRAVITY;
+	constexpr double m1 = cfg::link::MASS[0];
+	constexpr double m2 = cfg::link::MASS[1];
+	constexpr double L1 = cfg::link::LENGTH[0];
+	constexpr double L2 = cfg::link::LENGTH[1];
+	constexpr double u1 = cfg::joint::FRICTION[0];
+	constexpr double u2 = cfg::joint::FRICTION[1];
+
+	// M11 = M11_0 + 2 K cos(q2), M12 = M22 + K cos(q2), det M = D0 - K^2 cos(q2)^2
+	constexpr double K = m2 * L1 * L2;
+	constexpr double M22 = m2 * L2 * L2;
+	constexpr double M11_0 = (m1 + m2) * L1 * L1 + M22;
+	constexpr double D0 = (m1 + m2) * L1 * L1 * M22;
+	// G1 = G1_0 cos(q1) + G2_0 cos(q1 + q2), G2 = G2_0 cos(q1 + q2)
+	constexpr double G1_0 = (m1 + m2) * g * L1;
+	constexpr double G2_0 = m2 * g * L2;
+
+	// Overloaded per number type, compilers fuse the pair into one sincos call
+	inline void SinCos(const double x, double& s, double& c)
+	{
+		s = std::sin(x);
+		c = std::cos(x);
+	}
+
+	// Trigonometric terms shared by the kernels below
+	template <class T>
+	struct Trig
+	{
+		T s1, c1, s2, c2, s12, c12;
+	};
+
+	template <class T>
+	inline Trig<T> Angles(const T& q1, const T& q2)
+	{
+		Trig<T> t;
+		SinCos(q1, t.s1, t.c1);
+		SinCos(q2, t.s2, t.c2);
+		t.s12 = t.s1 * t.c2 + t.c1 * t.s2;
+		t.c12 = t.c1 * t.c2 - t.s1 * t.s2;
+		return t;
+	}
+
+	template <class T>
+	inline void Accelerations(const Trig<T>& t, const T& w1, const T& w2, T& a1, T& a2)
+	{
+		// Mass matrix and the explicit 2x2 inverse
+		const T Kc2 = K * t.c2;
+		const T M11 = M11_0 + 2.0 * Kc2;
+		const T M12 = M22 + Kc2;
+		const T inv = 1.0 / (D0 - Kc2 * t.c2 * K);
+
+		// Friction less Coriolis, centrifugal and gravity terms
+		const T Ks2 = K * t.s2;
+		const T G2 = G2_0 * t.c12;
+		const T b1 = Ks2 * w2 * (2.0 * w1 + w2) - u1 * w1 - G1_0 * t.c1 - G2;
+		const T b2 = -Ks2 * w1 * w1 - u2 * w2 - G2;
+
+		a1 = (M22 * b1 - M12 * b2) * inv;
+		a2 = (M11 * b2 - M12 * b1) * inv;
+	}
+
+	template <class T>
+	inline void Accelerations(const T& q1, const T& q2, const T& w1, const T& w2, T& a1, T& a2)
+	{
+		Accelerations(Angles(q1, q2), w1, w2, a1, a2);
+	}
+
+	// Kinetic w' M w / 2 and potential energy, zero with both links level
+	template <class T>
+	inline void Energy(const Trig<T>& t, const T& w1, const T& w2, T& kinetic, T& potential)
+	{
+		const T Kc2 = K * t.c2;
+		const T M11 = M11_0 + 2.0 * Kc2;
+		const T M12 = M22 + Kc2;
+
+		kinetic = 0.5 * (M11 * w1 * w1 + 2.0 * M12 * w1 * w2 + M22 * w2 * w2);
+		potential = G1_0 * t.s1 + G2_0 * t.s12;
+	}
+
+	// Rate the joint friction removes energy, u1 w1^2 + u2 w2^2
+	template <class T>
+	inline T Dissipation(const T& w1, const T& w2)
+	{
+		return u1 * w1 * w1 + u2 * w2 * w2;
+	}
+
+	// Accelerations and the lower two rows of the state Jacobian, d(a1, a2) / d(q1, q2, w1, w2)
+	template <class T>
+	inline void Jacobian(const Trig<T>& t, const T& w1, const T& w2, T& a1, T& a2, T da1[4], T da2[4])
+	{
+		const T Kc2 = K * t.c2;
+		const T Ks2 = K * t.s2;
+		const T M11 = M11_0 + 2.0 * Kc2;
+		const T M12 = M22 + Kc2;
+		const T inv = 1.0 / (D0 - Kc2 * t.c2 * K);
+
+		Accelerations(t, w1, w2, a1, a2);
+
+		// Partials of b, less dM/dq2 a for the q2 column
+		const T G2s = G2_0 * t.s12;
+		const T db1[4] =
+		{
+			G1_0 * t.s1 + G2s,
+			Kc2 * w2 * (2.0 * w1 + w2) + G2s + Ks2 * (2.0 * a1 + a2),
+			2.0 * Ks2 * w2 - u1,
+			2.0 * Ks2 * (w1 + w2)
+		};
+		const T db2[4] =
+		{
+			G2s,
+			-Kc2 * w1 * w1 + G2s + Ks2 * a1,
+			-2.0 * Ks2 * w1,
+			T(-u2)
+		};
+
+		for (int i = 0; i < 4; i++)
+		{
+			da1[i] = (M22 * db1[i] - M12 * db2[i]) * inv;
+			da2[i] = (M11 * db2[i] - M12 * db1[i]) * inv;
+		}
+	}
+
+	template <class T>
+	inline void Jacobian(const T& q1, const T& q2, const T& w1, const T& w2, T da1[4], T da2[4])
+	{
+		T a1, a2;
+		Jacobian(Angles(q1, q2), w1, w2, a1, a2, da1, da2);
+	}
+}
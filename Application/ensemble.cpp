@@ -0,0 +1,135 @@
+#include "ensemble.hpp"
+#include "kernel.hpp"
+
+#include <algorithm>
+
+
+template <class Real>
+Ensemble<Real>::Ensemble(const size_t size)
+	: m_Size{ size }
+{
+	// Round up to whole blocks for every ISA level, spare lanes hold a resting pendulum
+	const size_t padded = (size + kernels::BLOCK - 1) / kernels::BLOCK * kernels::BLOCK;
+
+	for (Array& a : m_State)
+		a.assign(padded, Real(0));
+}
+
+template <class Real>
+void Ensemble<Real>::Update(const double dt, const int steps)
+{
+	Real* const state[4] = { m_State[0].data(), m_State[1].data(), m_State[2].data(), m_State[3].data() };
+	const bool tracked = !m_Monitors.empty();
+
+	for (int i = 0; i < (tracked ? steps : 1); i++)
+	{
+		if constexpr (sizeof(Real) == 8)
+			kernels::Get().ensemble_f64(state, m_State[0].size(), dt, tracked ? 1 : steps);
+		else
+			kernels::Get().ensemble_f32(state, m_State[0].size(), dt, tracked ? 1 : steps);
+
+		if (tracked)
+			Track(0, m_Size, dt);
+	}
+}
+
+template <class Real>
+void Ensemble<Real>::Update(const double dt, const int steps, Pool& pool)
+{
+	static_assert(cfg::pool::CHUNK % kernels::BLOCK == 0, "Chunks must hold whole blocks");
+
+	const size_t size = m_State[0].size();
+	const size_t chunks = (size + cfg::pool::CHUNK - 1) / cfg::pool::CHUNK;
+	const kernels::Table& table = kernels::Get();
+
+	pool.For(chunks, [&](const size_t i)
+	{
+		const size_t begin = i * cfg::pool::CHUNK;
+		const size_t count = std::min(cfg::pool::CHUNK, size - begin);
+		Real* const state[4] = { m_State[0].data() + begin, m_State[1].data() + begin, m_State[2].data() + begin, m_State[3].data() + begin };
+		const bool tracked = !m_Monitors.empty();
+
+		for (int j = 0; j < (tracked ? steps : 1); j++)
+		{
+			if constexpr (sizeof(Real) == 8)
+				table.ensemble_f64(state, count, dt, tracked ? 1 : steps);
+			else
+				table.ensemble_f32(state, count, dt, tracked ? 1 : steps);
+
+			if (tracked)
+				Track(begin, std::min(begin + count, m_Size), dt);
+		}
+	});
+}
+
+template <class Real>
+void Ensemble<Real>::Set(const size_t i, const Vector& x)
+{
+	for (int j = 0; j < 4; j++)
+		m_State[j][i] = Real(x[j]);
+
+	if (!m_Monitors.empty())
+		m_Monitors[i].Reset(Get(i));
+}
+
+template <class Real>
+Vector Ensemble<Real>::Get(const size_t i) const
+{
+	return Vector{ m_State[0][i], m_State[1][i], m_State[2][i], m_State[3][i] };
+}
+
+template <class Real>
+Energy Ensemble<Real>::GetEnergy(const size_t i) const
+{
+	Vector dx;
+	return Monitor::Measure(Get(i), dx);
+}
+
+template <class Real>
+void Ensemble<Real>::StartMonitor()
+{
+	m_Monitors.resize(m_Size);
+
+	for (size_t i = 0; i < m_Size; i++)
+		m_Monitors[i].Reset(Get(i));
+}
+
+template <class Real>
+void Ensemble<Real>::StopMonitor()
+{
+	m_Monitors.clear();
+}
+
+template <class Real>
+const Monitor& Ensemble<Real>::GetMonitor(const size_t i) const
+{
+	return m_Monitors[i];
+}
+
+template <class Real>
+void Ensemble<Real>::Track(const size_t begin, const size_t end, const double dt)
+{
+	for (size_t i = begin; i < end; i++)
+		m_Monitors[i].Update(Get(i), dt);
+}
+
+template <class Real>
+size_t Ensemble<Real>::GetSize() const
+{
+	return m_Size;
+}
+
+template <class Real>
+size_t Ensemble<Real>::GetWidth() const
+{
+	return sizeof(Real) == 8 ? kernels::Get().width_f64 : kernels::Get().width_f32;
+}
+
+template <class Real>
+const typename Ensemble<Real>::Array& Ensemble<Real>::GetState(const int k) const
+{
+	return m_State[k];
+}
+
+template class Ensemble<double>;
+template class Ensemble<float>;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "pool.hpp"
+#include "simd.hpp"
+#include "config.hpp"
+#include "monitor.hpp"
+#include "integrator.hpp"
+
+#include <vector>
+
+
+// Independent double pendulums stored as aligned structure-of-arrays and
+// stepped with RK4 one register of lanes at a time by the widest kernel the
+// CPU supports. Real is double or float.
+template <class Real>
+class Ensemble
+{
+public:
+	using Array = std::vector<Real, simd::Allocator<Real>>;
+
+	Ensemble(const size_t size);
+
+	void Update(const double dt, const int steps = 1);
+	// Same, with cfg::pool::CHUNK lane chunks spread over the pool
+	void Update(const double dt, const int steps, Pool& pool);
+
+	void Set(const size_t i, const Vector& x);
+	Vector Get(const size_t i) const;
+	Energy GetEnergy(const size_t i) const;
+
+	// Track the energy drift of every pendulum from its current state. While on,
+	// updates call the kernel one step at a time so each step's friction work is counted.
+	void StartMonitor();
+	void StopMonitor();
+	const Monitor& GetMonitor(const size_t i) const;
+
+	size_t GetSize() const;
+	size_t GetWidth() const;
+	// Component k of every pendulum, ordered { q1, q2, w1, w2 } and padded to whole registers
+	const Array& GetState(const int k) const;
+
+private:
+	void Track(const size_t begin, const size_t end, const double dt);
+
+	size_t m_Size;
+	Array m_State[4];
+	std::vector<Monitor> m_Monitors;
+};
+
+extern template class Ensemble<double>;
+extern template class Ensemble<float>;
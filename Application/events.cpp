@@ -0,0 +1,78 @@
+#include "events.hpp"
+#include "hamiltonian.hpp"
+
+#include <iterator>
+
+
+namespace event
+{
+	Event Linear(const Vector& normal, const double offset, const int direction, const bool periodic, const Action action)
+	{
+		Event e{};
+		e.function = [](const Vector& x, const double* p)
+		{
+			return p[0] * x[0] + p[1] * x[1] + p[2] * x[2] + p[3] * x[3] - p[4];
+		};
+
+		for (int n = 0; n < 4; n++)
+			e.parameters[n] = normal[n];
+
+		e.parameters[4] = offset;
+		e.direction = direction;
+		e.periodic = periodic;
+		e.action = action;
+		return e;
+	}
+
+	Event Angle(const int index, const double value, const int direction, const Action action)
+	{
+		if (index < 0 || index > 1)
+			throw std::invalid_argument("Angle events index { q1, q2 }.");
+
+		Vector normal{};
+		normal[index] = 1.0;
+		return Linear(normal, value, direction, true, action);
+	}
+
+	Event Velocity(const int index, const int direction, const Action action)
+	{
+		if (index < 0 || index > 1)
+			throw std::invalid_argument("Velocity events index { w1, w2 }.");
+
+		Vector normal{};
+		normal[2 + index] = 1.0;
+		return Linear(normal, 0.0, direction, false, action);
+	}
+
+	Event Energy(const double value, const int direction, const Action action)
+	{
+		Event e{};
+		e.function = [](const Vector& x, const double* p)
+		{
+			return hamiltonian::Energy(hamiltonian::ToCanonical(x)) - p[0];
+		};
+		e.parameters[0] = value;
+		e.direction = direction;
+		e.periodic = false;
+		e.action = action;
+		return e;
+	}
+
+	Event Custom(double (*function)(const Vector& x, const double* parameters),
+				 const double* parameters, const int count, const int direction, const Action action)
+	{
+		if (count < 0 || count > int(std::size(Event{}.parameters)))
+			throw std::invalid_argument("Custom events take at most five parameters.");
+
+		Event e{};
+		e.function = function;
+
+		for (int n = 0; n < count; n++)
+			e.parameters[n] = parameters[n];
+
+		e.direction = direction;
+		e.periodic = false;
+		e.action = action;
+		return e;
+	}
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "config.hpp"
+#include "integrator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+
+// Event detection on the adaptive integrator. Every accepted step is checked
+// for sign changes of the registered event functions at cfg::event::SUBDIVIDE
+// points of its dense output, and each root is located on the same interpolant
+// by the Illinois method, so events are timed to cfg::event::TIME_TOL without
+// shrinking the step. Events live in fixed storage and nothing allocates.
+namespace event
+{
+	// What happens when an event fires
+	enum class Action
+	{
+		// Count it and carry on
+		Continue,
+		// Stop the run at the event
+		Terminate,
+		// Hand it to the run's handler, which returns Continue or Terminate
+		Callback
+	};
+
+	// Scalar function of the state, zero where the event happens
+	struct Event
+	{
+		double (*function)(const Vector& x, const double* parameters);
+		double parameters[5];
+		// +1 fires when the function rises through zero, -1 when it falls and 0 both
+		int direction;
+		// Compare modulo 2 pi, for functions of an angle
+		bool periodic;
+		Action action;
+	};
+
+	// An event located in time
+	struct Hit
+	{
+		int index;
+		double time;
+		Vector x;
+	};
+
+	// normal . x = offset, e.g. an angle or a velocity reaching a value
+	Event Linear(const Vector& normal, const double offset, const int direction, const bool periodic, const Action action);
+	// Joint angle index 0 or 1 passing value, modulo 2 pi
+	Event Angle(const int index, const double value, const int direction, const Action action);
+	// Joint velocity index 0 or 1 changing sign, the turning points of a swing
+	Event Velocity(const int index, const int direction, const Action action);
+	// Total energy crossing value, rising for a driven pendulum or falling as friction drains it
+	Event Energy(const double value, const int direction, const Action action);
+	// User function with up to five parameters, a captureless lambda will do
+	Event Custom(double (*function)(const Vector& x, const double* parameters),
+				 const double* parameters, const int count, const int direction, const Action action);
+
+	class Detector
+	{
+	public:
+		Detector()
+			: m_Events{}, m_Size{ 0 }, m_Values{}, m_Counts{}, m_Last{}
+		{
+		}
+
+		// Returns the event's index, passed back in each Hit
+		int Add(const Event& e)
+		{
+			if (m_Size == cfg::event::MAX_EVENTS)
+				throw std::length_error("Too many events registered on one detector.");
+
+			m_Events[m_Size] = e;
+			m_Counts[m_Size] = 0;
+			return m_Size++;
+		}
+
+		void Clear()
+		{
+			m_Size = 0;
+		}
+
+		// Step the solver from its current state until time until or a terminating
+		// event, calling handler(hit) for Callback events. Returns true when an
+		// event terminated the run, in which case the solver is reset to the hit,
+		// and otherwise the solver is reset to its dense output at until, so a
+		// later Run carries on from there without skipping any event. A step the
+		// solver cannot take also ends the run, short of until.
+		template <class F, class H>
+		bool Run(integrator::DormandPrince& solver, F&& f, const double until, H&& handler)
+		{
+			double t0 = solver.GetTime();
+
+			for (int e = 0; e < m_Size; e++)
+				m_Values[e] = Value(e, solver.GetState());
+
+			while (t0 < until)
+			{
+				if (!solver.Step(f))
+					return false;
+
+				const double start = solver.GetStartTime();
+				const double end = std::min(solver.GetTime(), until);
+
+				// Several looks per step, a long step can cross and come back between its ends
+				for (int k = 1; k <= cfg::event::SUBDIVIDE; k++)
+				{
+					const double t1 = start + (end - start) * k / cfg::event::SUBDIVIDE;
+
+					if (Check(solver, t0, t1, handler))
+					{
+						solver.Reset(m_Last.x, m_Last.time);
+						return true;
+					}
+
+					t0 = t1;
+				}
+			}
+
+			// The last step usually overshoots
+			if (solver.GetTime() > until)
+				solver.Reset(solver.Sample(until), until);
+
+			return false;
+		}
+
+		// Run with Callback events treated as Continue
+		template <class F>
+		bool Run(integrator::DormandPrince& solver, F&& f, const double until)
+		{
+			return Run(solver, f, until, [](const Hit&) { return Action::Continue; });
+		}
+
+		// Most recent hit of any event
+		const Hit& GetLast() const { return m_Last; }
+		// Times event index has fired since it was added
+		long long GetCount(const int index) const { return m_Counts[index]; }
+		int GetSize() const { return m_Size; }
+
+	private:
+		double Value(const int index, const Vector& x) const
+		{
+			constexpr double PI = 3.14159265358979323846;
+
+			const Event& e = m_Events[index];
+			const double g = e.function(x, e.parameters);
+
+			// Into [-pi, pi)
+			return e.periodic ? g - 2 * PI * std::floor((g + PI) / (2 * PI)) : g;
+		}
+
+		// Locate and act on every event changing sign over [t0, t1] in time order
+		template <class H>
+		bool Check(const integrator::DormandPrince& solver, const double t0, const double t1, H&& handler)
+		{
+			constexpr double PI = 3.14159265358979323846;
+
+			Hit hits[cfg::event::MAX_EVENTS];
+			int count = 0;
+
+			for (int e = 0; e < m_Size; e++)
+			{
+				const double g0 = m_Values[e];
+				const double g1 = Value(e, solver.Sample(t1));
+				m_Values[e] = g1;
+
+				const int direction = m_Events[e].direction;
+				const bool rising = g0 < 0.0 && g1 >= 0.0;
+				const bool falling = g0 > 0.0 && g1 <= 0.0;
+				// A jump by half a turn is the wrap of a periodic function, not a root
+				const bool wrapped = m_Events[e].periodic && std::abs(g1 - g0) > PI;
+
+				if (wrapped || !((rising && direction >= 0) || (falling && direction <= 0)))
+					continue;
+
+				// Insertion keeps the hits sorted by time
+				const double time = Locate(solver, e, t0, g0, t1, g1);
+				int i = count++;
+
+				for (; i > 0 && hits[i - 1].time > time; i--)
+					hits[i] = hits[i - 1];
+
+				hits[i] = Hit{ e, time, Vector{} };
+			}
+
+			for (int i = 0; i < count; i++)
+			{
+				Hit& hit = hits[i];
+				hit.x = solver.Sample(hit.time);
+				m_Counts[hit.index]++;
+				m_Last = hit;
+
+				const Action action = m_Events[hit.index].action;
+
+				if (action == Action::Terminate || (action == Action::Callback && handler(hit) == Action::Terminate))
+					return true;
+			}
+
+			return false;
+		}
+
+		// Illinois: regula falsi halving the stale end's value so both ends keep moving.
+		// Returns the bracket end past the root, so a run resumed from the hit does not
+		// see the same sign change again.
+		double Locate(const integrator::DormandPrince& solver, const int index,
+					  double a, double ga, double b, double gb) const
+		{
+			int side = 0;
+
+			for (int i = 0; i < cfg::event::MAX_ITERATIONS && b - a > cfg::event::TIME_TOL && gb != 0.0; i++)
+			{
+				const double c = (a * gb - b * ga) / (gb - ga);
+				const double gc = Value(index, solver.Sample(c));
+
+				if (gc == 0.0)
+					return c;
+
+				if ((gc > 0.0) == (gb > 0.0))
+				{
+					b = c;
+					gb = gc;
+
+					if (side == -1)
+						ga /= 2;
+
+					side = -1;
+				}
+				else
+				{
+					a = c;
+					ga = gc;
+
+					if (side == 1)
+						gb /= 2;
+
+					side = 1;
+				}
+			}
+
+			return b;
+		}
+
+		Event m_Events[cfg::event::MAX_EVENTS];
+		int m_Size;
+		double m_Values[cfg::event::MAX_EVENTS];
+		long long m_Counts[cfg::event::MAX_EVENTS];
+		Hit m_Last;
+	};
+}
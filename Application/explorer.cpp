@@ -0,0 +1,504 @@
+#include "explorer.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+
+namespace
+{
+	constexpr double PI = 3.14159265358979323846;
+	constexpr int TILE = cfg::flip::TILE;
+
+	constexpr uint32_t BACKGROUND = 0xFF000000u
+		| uint32_t(cfg::explore::BACKGROUND[0]) << 16
+		| uint32_t(cfg::explore::BACKGROUND[1]) << 8
+		| uint32_t(cfg::explore::BACKGROUND[2]);
+
+	// Pixels per sample side in a pass
+	int Block(const int level)
+	{
+		return 1 << (cfg::explore::LEVELS - 1 - level);
+	}
+
+	// Pixels per tile side in a pass
+	int Span(const int level)
+	{
+		return TILE * Block(level);
+	}
+
+	// Rounding towards minus infinity, world pixels run both ways from the origin
+	int FloorDiv(const int a, const int b)
+	{
+		return a / b - (a % b != 0 && (a < 0) != (b < 0));
+	}
+
+	uint64_t Key(const int tx, const int ty)
+	{
+		return uint64_t(uint32_t(tx)) << 32 | uint32_t(ty);
+	}
+
+	// Move a width x height grid by (dx, dy) in place, filling what is uncovered
+	template <class T>
+	void Shift(std::vector<T>& grid, const int w, const int h, const int dx, const int dy, const T fill)
+	{
+		for (int k = 0; k < h; k++)
+		{
+			// Bottom up when moving down, so no row is overwritten before it is read
+			const int y = dy > 0 ? h - 1 - k : k;
+			const int sy = y - dy;
+			T* row = grid.data() + size_t(y) * w;
+
+			if (sy < 0 || sy >= h || std::abs(dx) >= w)
+			{
+				std::fill_n(row, w, fill);
+				continue;
+			}
+
+			const T* source = grid.data() + size_t(sy) * w;
+
+			if (dx >= 0)
+			{
+				std::memmove(row + dx, source, size_t(w - dx) * sizeof(T));
+				std::fill_n(row, dx, fill);
+			}
+			else
+			{
+				std::memmove(row, source - dx, size_t(w + dx) * sizeof(T));
+				std::fill_n(row + w + dx, -dx, fill);
+			}
+		}
+	}
+
+	// Leave a core for the window and physics threads, the driver works as one of the pool
+	size_t Workers()
+	{
+		// Zero when unknown, taken as two
+		return std::max(2u, std::thread::hardware_concurrency()) - 1;
+	}
+}
+
+Explorer::Explorer()
+	: m_View{}, m_ShiftX{ 0 }, m_ShiftY{ 0 }, m_Moved{ false }, m_Image{}, m_Levels{}, m_Dirty{}, m_Ready{},
+	m_Pool{ Workers() }, m_Patches{}, m_Done{}, m_Pending{}, m_Generation{ 0 }, m_Lattice{ 0 },
+	m_Finished{ 0 }, m_Tiles{ 0 }, m_Stop{ false }
+{
+	m_Thread = std::thread(&Explorer::Loop, this);
+}
+
+Explorer::~Explorer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+		m_Generation++;
+		m_Lattice++;
+	}
+
+	m_Wake.notify_all();
+	m_Thread.join();
+}
+
+void Explorer::Resize(const int width, const int height)
+{
+	if (width == m_View.width && height == m_View.height)
+		return;
+
+	const double scale = m_View.scale;
+
+	// The whole square of angles fits the first view
+	if (scale == 0.0)
+		m_View.scale = 2 * PI / std::max(1, std::min(width, height));
+
+	// Same centre, in the middle of the new image
+	const double c1 = scale == 0.0 ? 0.0 : m_View.a1 + (m_View.x + m_View.width / 2.0) * scale;
+	const double c2 = scale == 0.0 ? 0.0 : m_View.a2 - (m_View.y + m_View.height / 2.0) * scale;
+
+	m_View.width = width;
+	m_View.height = height;
+	m_View.x = 0;
+	m_View.y = 0;
+	m_View.a1 = c1 - width / 2.0 * m_View.scale;
+	m_View.a2 = c2 + height / 2.0 * m_View.scale;
+	m_Image.assign(size_t(width) * height, BACKGROUND);
+	m_Levels.assign(m_Image.size(), 0);
+	Clear();
+	Restart();
+}
+
+void Explorer::Pan(const int dx, const int dy)
+{
+	m_View.x -= dx;
+	m_View.y -= dy;
+	m_ShiftX += dx;
+	m_ShiftY += dy;
+}
+
+void Explorer::Zoom(const double factor, const int x, const int y)
+{
+	Scroll();
+
+	const int w = m_View.width;
+	const int h = m_View.height;
+	const double scale = m_View.scale / factor;
+
+	// Keep the angles under (x, y) where they are, on a new lattice from the image's corner
+	m_View.a1 += (m_View.x + x + 0.5) * m_View.scale - (x + 0.5) * scale;
+	m_View.a2 -= (m_View.y + y + 0.5) * m_View.scale - (y + 0.5) * scale;
+	m_View.x = 0;
+	m_View.y = 0;
+	m_View.scale = scale;
+
+	// Stretch the old picture as a stand-in until the first pass lands
+	std::vector<uint32_t> image(m_Image.size(), BACKGROUND);
+
+	for (int v = 0; v < h; v++)
+	{
+		const int sy = int(std::floor(y + (v - y) / factor));
+
+		if (sy < 0 || sy >= h)
+			continue;
+
+		for (int u = 0; u < w; u++)
+		{
+			const int sx = int(std::floor(x + (u - x) / factor));
+
+			if (sx >= 0 && sx < w)
+				image[size_t(v) * w + u] = m_Image[size_t(sy) * w + sx];
+		}
+	}
+
+	m_Image.swap(image);
+	std::fill(m_Levels.begin(), m_Levels.end(), 0);
+	Clear();
+	Restart();
+}
+
+void Explorer::Scroll()
+{
+	const int dx = m_ShiftX;
+	const int dy = m_ShiftY;
+
+	if (dx == 0 && dy == 0)
+		return;
+
+	const int w = m_View.width;
+	const int h = m_View.height;
+
+	m_ShiftX = 0;
+	m_ShiftY = 0;
+	Shift(m_Image, w, h, dx, dy, BACKGROUND);
+	Shift(m_Levels, w, h, dx, dy, uint8_t(0));
+
+	// World rectangles of the image before and after
+	const int x0 = m_View.x + dx;
+	const int y0 = m_View.y + dy;
+	const int x1 = m_View.x;
+	const int y1 = m_View.y;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// A tile stays finished only while all of it on screen was on screen before, the rest was lost
+	for (int level = 0; level < cfg::explore::LEVELS; level++)
+	{
+		const int span = Span(level);
+
+		for (auto it = m_Done[level].begin(); it != m_Done[level].end();)
+		{
+			const int tx = int32_t(uint32_t(*it >> 32));
+			const int ty = int32_t(uint32_t(*it));
+			const int left = std::max(tx * span, x1);
+			const int top = std::max(ty * span, y1);
+			const int right = std::min((tx + 1) * span, x1 + w);
+			const int bottom = std::min((ty + 1) * span, y1 + h);
+
+			const bool kept = left < right && top < bottom
+				&& left >= x0 && right <= x0 + w && top >= y0 && bottom <= y0 + h;
+
+			it = kept ? std::next(it) : m_Done[level].erase(it);
+		}
+	}
+}
+
+void Explorer::Clear()
+{
+	m_ShiftX = 0;
+	m_ShiftY = 0;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Patches.clear();
+
+	for (std::unordered_set<uint64_t>& done : m_Done)
+		done.clear();
+
+	m_Lattice++;
+}
+
+void Explorer::Restart()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Pending = m_View;
+		m_Generation++;
+		Survey(m_View, nullptr);
+	}
+
+	m_Moved = true;
+	m_Wake.notify_one();
+}
+
+void Explorer::Survey(const View& view, std::vector<std::pair<int, int>>* orders)
+{
+	uint64_t tiles = 0;
+	uint64_t finished = 0;
+
+	// Every tile touching the view, those finished under an earlier view already count
+	for (int level = 0; level < cfg::explore::LEVELS; level++)
+	{
+		const int span = Span(level);
+
+		for (int ty = FloorDiv(view.y, span); ty <= FloorDiv(view.y + view.height - 1, span); ty++)
+		{
+			for (int tx = FloorDiv(view.x, span); tx <= FloorDiv(view.x + view.width - 1, span); tx++)
+			{
+				tiles++;
+
+				if (m_Done[level].count(Key(tx, ty)) > 0)
+					finished++;
+				else if (orders != nullptr)
+					orders[level].emplace_back(tx, ty);
+			}
+		}
+	}
+
+	m_Tiles.store(tiles, std::memory_order_relaxed);
+	m_Finished.store(finished, std::memory_order_relaxed);
+}
+
+const std::vector<Explorer::Rect>& Explorer::Update()
+{
+	m_Dirty.clear();
+
+	// However many motion events arrived, the image moves once a frame
+	if (m_ShiftX != 0 || m_ShiftY != 0)
+	{
+		Scroll();
+		Restart();
+	}
+
+	if (m_Moved)
+		m_Dirty.push_back(Rect{ 0, 0, m_View.width, m_View.height });
+
+	m_Moved = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Ready.swap(m_Patches);
+	}
+
+	for (const Patch& patch : m_Ready)
+	{
+		// The part of the patch on screen
+		const Rect& p = patch.rect;
+		const int left = std::max(p.x, m_View.x);
+		const int top = std::max(p.y, m_View.y);
+		const int right = std::min(p.x + p.w, m_View.x + m_View.width);
+		const int bottom = std::min(p.y + p.h, m_View.y + m_View.height);
+		const uint8_t level = uint8_t(patch.level + 1);
+
+		if (left >= right || top >= bottom)
+			continue;
+
+		for (int y = top; y < bottom; y++)
+		{
+			for (int x = left; x < right; x++)
+			{
+				const uint32_t pixel = patch.pixels[size_t(y - p.y) * p.w + x - p.x];
+				const size_t i = size_t(y - m_View.y) * m_View.width + x - m_View.x;
+
+				if (pixel != 0 && level >= m_Levels[i])
+				{
+					m_Image[i] = pixel;
+					m_Levels[i] = level;
+				}
+			}
+		}
+
+		m_Dirty.push_back(Rect{ left - m_View.x, top - m_View.y, right - left, bottom - top });
+	}
+
+	m_Ready.clear();
+	return m_Dirty;
+}
+
+void Explorer::Loop()
+{
+	uint64_t done = 0;
+
+	while (true)
+	{
+		View view;
+		uint64_t generation;
+		uint64_t lattice;
+
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Wake.wait(lock, [&] { return m_Stop || m_Generation.load(std::memory_order_relaxed) != done; });
+
+			if (m_Stop)
+				return;
+
+			view = m_Pending;
+			generation = m_Generation.load(std::memory_order_relaxed);
+			lattice = m_Lattice.load(std::memory_order_relaxed);
+		}
+
+		Render(view, generation, lattice);
+		done = generation;
+	}
+}
+
+void Explorer::Render(const View& view, const uint64_t generation, const uint64_t lattice)
+{
+	std::vector<std::pair<int, int>> orders[cfg::explore::LEVELS];
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (m_Generation.load(std::memory_order_relaxed) != generation)
+			return;
+
+		// Again, tiles an earlier view left in flight may have finished since Restart
+		Survey(view, orders);
+	}
+
+	// One pass per level so a coarse sample is always on screen before the finer ones around it
+	for (int level = 0; level < cfg::explore::LEVELS; level++)
+	{
+		const int span = Span(level);
+		std::vector<std::pair<int, int>>& order = orders[level];
+
+		// Centre of the view first, where the eye is
+		auto Distance = [&](const std::pair<int, int>& t)
+			{
+				const double dx = (t.first + 0.5) * span - view.x - view.width / 2.0;
+				const double dy = (t.second + 0.5) * span - view.y - view.height / 2.0;
+				return dx * dx + dy * dy;
+			};
+
+		std::sort(order.begin(), order.end(), [&](const auto& a, const auto& b) { return Distance(a) < Distance(b); });
+
+		m_Pool.For(order.size(), [&](const size_t i)
+		{
+			if (m_Generation.load(std::memory_order_relaxed) == generation)
+				Tile(view, generation, lattice, level, order[i].first, order[i].second);
+		});
+
+		if (m_Generation.load(std::memory_order_relaxed) != generation)
+			return;
+	}
+}
+
+void Explorer::Tile(const View& view, const uint64_t generation, const uint64_t lattice, const int level, const int tx, const int ty)
+{
+	const int block = Block(level);
+	const int span = Span(level);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Finished since the view was taken, by a tile an earlier view left in flight
+		if (m_Done[level].count(Key(tx, ty)) > 0)
+		{
+			if (m_Generation.load(std::memory_order_relaxed) == generation)
+				m_Finished.fetch_add(1, std::memory_order_relaxed);
+
+			return;
+		}
+	}
+
+	double a1[FlipMap::LANES];
+	double a2[FlipMap::LANES];
+	float times[FlipMap::LANES];
+	int px[FlipMap::LANES];
+	int py[FlipMap::LANES];
+	size_t count = 0;
+
+	// The whole tile, off screen parts included, so it stays finished whichever way the view pans
+	for (int j = 0; j < TILE; j++)
+	{
+		for (int i = 0; i < TILE; i++)
+		{
+			const int sx = tx * TILE + i;
+			const int sy = ty * TILE + j;
+
+			// Even samples sit on the previous pass's, which already painted this corner
+			if (level > 0 && (sx & 1) == 0 && (sy & 1) == 0)
+				continue;
+
+			px[count] = sx * block;
+			py[count] = sy * block;
+			a1[count] = view.a1 + (px[count] + 0.5) * view.scale;
+			a2[count] = view.a2 - (py[count] + 0.5) * view.scale;
+			count++;
+		}
+	}
+
+	if (!FlipMap::Integrate(a1, a2, times, nullptr, count, &m_Lattice, lattice))
+		return;
+
+	Patch patch;
+	patch.rect = Rect{ tx * span, ty * span, span, span };
+	patch.level = level;
+	patch.pixels.assign(size_t(span) * span, 0);
+
+	for (size_t k = 0; k < count; k++)
+	{
+		const uint32_t colour = FlipMap::Colour(times[k]);
+
+		for (int y = py[k]; y < py[k] + block; y++)
+			std::fill_n(&patch.pixels[size_t(y - patch.rect.y) * span + px[k] - patch.rect.x], block, colour);
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// Good for any view of the same lattice, pans since will prune it if they uncovered part of it
+	if (m_Lattice.load(std::memory_order_relaxed) == lattice)
+	{
+		m_Patches.push_back(std::move(patch));
+		m_Done[level].insert(Key(tx, ty));
+
+		if (m_Generation.load(std::memory_order_relaxed) == generation)
+			m_Finished.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+const uint32_t* Explorer::GetImage() const
+{
+	return m_Image.data();
+}
+
+int Explorer::GetWidth() const
+{
+	return m_View.width;
+}
+
+int Explorer::GetHeight() const
+{
+	return m_View.height;
+}
+
+double Explorer::GetProgress() const
+{
+	const uint64_t tiles = m_Tiles.load(std::memory_order_relaxed);
+	return tiles > 0 ? double(m_Finished.load(std::memory_order_relaxed)) / tiles : 1.0;
+}
+
+Vector Explorer::GetState(const int x, const int y) const
+{
+	return FlipMap::Start(
+		m_View.a1 + (m_View.x + x + 0.5) * m_View.scale,
+		m_View.a2 - (m_View.y + y + 0.5) * m_View.scale
+	);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "flip.hpp"
+#include "pool.hpp"
+#include "config.hpp"
+#include "integrator.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <unordered_set>
+
+
+// Live flip time map of the view on screen. A driver thread renders each view
+// coarse to fine over a worker pool, cfg::explore::LEVELS passes from blocks of
+// 2^(LEVELS - 1) pixels down to single pixels, nearest the centre first. Tiles
+// sit on a lattice of world pixels fixed to the angles until the scale changes,
+// so a pan only shifts the image and renders what it uncovers, while a zoom or
+// resize starts a new lattice whose first patches abandon those of the last.
+// All calls are from the window thread and never wait on the computation.
+class Explorer
+{
+public:
+	// Pixel rectangle of the image
+	struct Rect
+	{
+		int x;
+		int y;
+		int w;
+		int h;
+	};
+
+	Explorer();
+	~Explorer();
+
+	Explorer(const Explorer&) = delete;
+	Explorer& operator=(const Explorer&) = delete;
+
+	// New image size, restarting the map over the same centre
+	void Resize(const int width, const int height);
+	// Move the picture by a pixel offset, keeping what is still on screen. Offsets
+	// add up until the next Update, which shifts the image once per frame.
+	void Pan(const int dx, const int dy);
+	// Magnify by factor about pixel (x, y)
+	void Zoom(const double factor, const int x, const int y);
+
+	// Apply finished tiles, returns the rectangles of the image changed since the last call
+	const std::vector<Rect>& Update();
+	// ARGB pixels, GetWidth per row
+	const uint32_t* GetImage() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	// Fraction of the current view's tiles finished
+	double GetProgress() const;
+	// Pendulum at rest started from the angles under pixel (x, y)
+	Vector GetState(const int x, const int y) const;
+
+private:
+	struct View
+	{
+		int width;
+		int height;
+		// World pixel at the top left of the image
+		int x;
+		int y;
+		// Angles at the top left corner of world pixel (0, 0) and radians per pixel
+		double a1;
+		double a2;
+		double scale;
+	};
+
+	// Finished tile in world pixels, transparent pixels keep what the image already has
+	struct Patch
+	{
+		Rect rect;
+		int level;
+		std::vector<uint32_t> pixels;
+	};
+
+	void Loop();
+	void Render(const View& view, const uint64_t generation, const uint64_t lattice);
+	void Tile(const View& view, const uint64_t generation, const uint64_t lattice, const int level, const int tx, const int ty);
+	// Shift the image by the pans since the last call and forget tiles it uncovered
+	void Scroll();
+	// Start a new lattice at the current scale, dropping every finished tile
+	void Clear();
+	// Hand the view to the driver, which skips the old view's tiles not yet started
+	void Restart();
+	// Count the view's tiles and those finished, listing the rest per pass if asked, under the lock
+	void Survey(const View& view, std::vector<std::pair<int, int>>* orders);
+
+	View m_View;
+	int m_ShiftX;
+	int m_ShiftY;
+	bool m_Moved;
+	std::vector<uint32_t> m_Image;
+	// Per pixel, one more than the pass that painted it, so no coarse patch covers a finer one
+	std::vector<uint8_t> m_Levels;
+	std::vector<Rect> m_Dirty;
+	std::vector<Patch> m_Ready;
+
+	Pool m_Pool;
+	std::thread m_Thread;
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::vector<Patch> m_Patches;
+	// Tiles of the lattice finished and whole on screen, per pass
+	std::unordered_set<uint64_t> m_Done[cfg::explore::LEVELS];
+	View m_Pending;
+	std::atomic<uint64_t> m_Generation;
+	// Changes with the lattice, cancelling the tiles in flight
+	std::atomic<uint64_t> m_Lattice;
+	std::atomic<uint64_t> m_Finished;
+	std::atomic<uint64_t> m_Tiles;
+	bool m_Stop;
+};
@@ -0,0 +1,302 @@
+#pragma once
+
+#include "dynamics.hpp"
+#include "chain.hpp"
+#include "robot.hpp"
+#include "config.hpp"
+
+#include <array>
+#include <cmath>
+#include <vector>
+#include <type_traits>
+
+
+// Compile-time link parameters, each exposing constexpr Mass(i), Length(i) and Friction(i)
+namespace params
+{
+	// The double pendulum from cfg::link and cfg::joint
+	struct Pendulum
+	{
+		static constexpr size_t SIZE = std::size(cfg::link::MASS);
+		static constexpr double Mass(const size_t i) { return cfg::link::MASS[i]; }
+		static constexpr double Length(const size_t i) { return cfg::link::LENGTH[i]; }
+		static constexpr double Friction(const size_t i) { return cfg::joint::FRICTION[i]; }
+	};
+
+	// The chain from cfg::chain
+	struct Config
+	{
+		static constexpr size_t SIZE = std::size(cfg::chain::MASS);
+		static constexpr double Mass(const size_t i) { return cfg::chain::MASS[i]; }
+		static constexpr double Length(const size_t i) { return cfg::chain::LENGTH[i]; }
+		static constexpr double Friction(const size_t i) { return cfg::chain::FRICTION[i]; }
+	};
+}
+
+// Planar chain with the link count and parameters fixed at compile time. The
+// equations are written in absolute link angles, where the mass matrix is
+// A[j][l] * cos(t_j - t_l) with A folded into a constexpr table, then solved
+// by elimination over std::array so every loop has a constant trip count.
+template <size_t N, class Params = params::Config>
+class FixedChain
+{
+public:
+	static_assert(N > 0, "FixedChain needs at least one link");
+
+	using Array = std::array<double, N>;
+
+	FixedChain()
+		: m_Pos{}, m_Vel{}, m_Acc{}
+	{
+	}
+
+	void Update(const double dt)
+	{
+		Array k1q, k1w, k2q, k2w, k3q, k3w, k4q, k4w;
+		Array q, w;
+
+		// Classic fourth-order Runge-Kutta over the whole chain
+		k1q = m_Vel;
+		Accelerations(m_Pos.data(), m_Vel.data(), k1w.data());
+
+		for (size_t i = 0; i < N; i++)
+		{
+			q[i] = m_Pos[i] + 0.5 * dt * k1q[i];
+			w[i] = m_Vel[i] + 0.5 * dt * k1w[i];
+		}
+
+		k2q = w;
+		Accelerations(q.data(), w.data(), k2w.data());
+
+		for (size_t i = 0; i < N; i++)
+		{
+			q[i] = m_Pos[i] + 0.5 * dt * k2q[i];
+			w[i] = m_Vel[i] + 0.5 * dt * k2w[i];
+		}
+
+		k3q = w;
+		Accelerations(q.data(), w.data(), k3w.data());
+
+		for (size_t i = 0; i < N; i++)
+		{
+			q[i] = m_Pos[i] + dt * k3q[i];
+			w[i] = m_Vel[i] + dt * k3w[i];
+		}
+
+		k4q = w;
+		Accelerations(q.data(), w.data(), k4w.data());
+
+		for (size_t i = 0; i < N; i++)
+		{
+			m_Pos[i] += dt / 6 * (k1q[i] + 2 * k2q[i] + 2 * k3q[i] + k4q[i]);
+			m_Vel[i] += dt / 6 * (k1w[i] + 2 * k2w[i] + 2 * k3w[i] + k4w[i]);
+			m_Acc[i] = k1w[i];
+		}
+	}
+
+	void Restart()
+	{
+		m_Pos.fill(0.0);
+		m_Vel.fill(0.0);
+		m_Acc.fill(0.0);
+	}
+
+	static void Accelerations(const double* q, const double* w, double* a)
+	{
+		Array s, c, v;
+		double st = 0.0;
+		double ct = 1.0;
+		double wt = 0.0;
+
+		// Absolute angles and rates, t_j = q_0 + ... + q_j
+		for (size_t j = 0; j < N; j++)
+		{
+			double sq, cq;
+			dynamics::SinCos(q[j], sq, cq);
+
+			const double sn = st * cq + ct * sq;
+			ct = ct * cq - st * sq;
+			st = sn;
+			wt += w[j];
+
+			s[j] = st;
+			c[j] = ct;
+			v[j] = wt;
+		}
+
+		// M tdd = Q - C - G, with joint friction mapped onto the absolute angles
+		std::array<Array, N> M;
+		Array b;
+
+		for (size_t j = 0; j < N; j++)
+		{
+			const double next = j + 1 < N ? Params::Friction(j + 1) * w[j + 1] : 0.0;
+			b[j] = next - Params::Friction(j) * w[j] - GRAVITY[j] * c[j];
+			M[j][j] = INERTIA[j][j];
+		}
+
+		// Only the upper triangle is computed, the diagonal is constant and sin(0) drops out
+		for (size_t j = 0; j < N; j++)
+		{
+			for (size_t l = j + 1; l < N; l++)
+			{
+				const double cjl = c[j] * c[l] + s[j] * s[l];
+				const double sjl = s[j] * c[l] - c[j] * s[l];
+
+				M[j][l] = M[l][j] = INERTIA[j][l] * cjl;
+				b[j] -= INERTIA[j][l] * sjl * v[l] * v[l];
+				b[l] += INERTIA[j][l] * sjl * v[j] * v[j];
+			}
+		}
+
+		// Gaussian elimination without pivoting, M is symmetric positive definite
+		Array inv;
+
+		for (size_t k = 0; k < N; k++)
+		{
+			// The first pivot is untouched by elimination and folds to a constant
+			inv[k] = k == 0 ? 1.0 / INERTIA[0][0] : 1.0 / M[k][k];
+
+			for (size_t j = k + 1; j < N; j++)
+			{
+				const double f = M[j][k] * inv[k];
+
+				for (size_t l = k + 1; l < N; l++)
+					M[j][l] -= f * M[k][l];
+
+				b[j] -= f * b[k];
+			}
+		}
+
+		for (size_t k = N; k-- > 0;)
+		{
+			for (size_t l = k + 1; l < N; l++)
+				b[k] -= M[k][l] * b[l];
+
+			b[k] *= inv[k];
+		}
+
+		// Back to joint accelerations
+		for (size_t j = 0; j < N; j++)
+			a[j] = j == 0 ? b[0] : b[j] - b[j - 1];
+	}
+
+	constexpr size_t GetSize() const
+	{
+		return N;
+	}
+
+	constexpr double GetLength(const size_t i) const
+	{
+		return Params::Length(i);
+	}
+
+	void GetLinkFrames(std::vector<Coord>& frames) const
+	{
+		frames.resize(N);
+
+		double x = 0.0;
+		double y = 0.0;
+		double angle = 0.0;
+
+		for (size_t i = 0; i < N; i++)
+		{
+			angle += m_Pos[i];
+			const double c = cos(angle);
+			const double s = sin(angle);
+
+			frames[i] = Coord{ x + Params::Length(i) / 2 * c, y + Params::Length(i) / 2 * s };
+			x += Params::Length(i) * c;
+			y += Params::Length(i) * s;
+		}
+	}
+
+	void GetJointFrames(std::vector<Coord>& frames) const
+	{
+		frames.resize(N);
+
+		double x = 0.0;
+		double y = 0.0;
+		double angle = 0.0;
+
+		for (size_t i = 0; i < N; i++)
+		{
+			frames[i] = Coord{ x, y };
+			angle += m_Pos[i];
+			x += Params::Length(i) * cos(angle);
+			y += Params::Length(i) * sin(angle);
+		}
+	}
+
+	const Array& GetPositions() const { return m_Pos; }
+	const Array& GetVelocities() const { return m_Vel; }
+	const Array& GetAccelerations() const { return m_Acc; }
+
+private:
+	// Mass carried by link j and everything outboard of it
+	static constexpr double Tail(const size_t j)
+	{
+		double m = 0.0;
+
+		for (size_t k = j; k < N; k++)
+			m += Params::Mass(k);
+
+		return m;
+	}
+
+	static constexpr std::array<Array, N> Inertia()
+	{
+		std::array<Array, N> A{};
+
+		for (size_t j = 0; j < N; j++)
+		{
+			for (size_t l = 0; l < N; l++)
+				A[j][l] = Params::Length(j) * Params::Length(l) * Tail(j > l ? j : l);
+		}
+
+		return A;
+	}
+
+	static constexpr Array Gravity()
+	{
+		Array G{};
+
+		for (size_t j = 0; j < N; j++)
+			G[j] = cfg::env::GRAVITY * Params::Length(j) * Tail(j);
+
+		return G;
+	}
+
+	static constexpr std::array<Array, N> INERTIA = Inertia();
+	static constexpr Array GRAVITY = Gravity();
+
+	Array m_Pos;
+	Array m_Vel;
+	Array m_Acc;
+};
+
+// Fixed chains stay on the stack up to MAX_FIXED_LINKS, longer ones fall back to the runtime Chain
+template <size_t N, class Params = params::Config>
+using ChainFor = std::conditional_t<(N <= cfg::sim::MAX_FIXED_LINKS), FixedChain<N, Params>, Chain>;
+
+template <size_t N, class Params = params::Config>
+ChainFor<N, Params> MakeChain()
+{
+	if constexpr (N <= cfg::sim::MAX_FIXED_LINKS)
+	{
+		return FixedChain<N, Params>{};
+	}
+	else
+	{
+		std::vector<double> mass(N), length(N), friction(N);
+
+		for (size_t i = 0; i < N; i++)
+		{
+			mass[i] = Params::Mass(i);
+			length[i] = Params::Length(i);
+			friction[i] = Params::Friction(i);
+		}
+
+		return Chain(mass, length, friction);
+	}
+}
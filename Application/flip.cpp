@@ -0,0 +1,626 @@
+#include "flip.hpp"
+#include "kernel.hpp"
+#include "simd.hpp"
+#include "hamiltonian.hpp"
+
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+
+namespace
+{
+	using Array = std::vector<double, simd::Allocator<double>>;
+
+	constexpr double PI = 3.14159265358979323846;
+
+	static_assert(FlipMap::LANES % kernels::BLOCK == 0, "Tiles must hold whole blocks");
+
+	// Everything a checkpoint must agree on to be resumed
+	struct Header
+	{
+		char magic[8];
+		int32_t width;
+		int32_t height;
+		int32_t tile;
+		int32_t check;
+		int32_t refine;
+		int32_t cell;
+		int32_t buckets;
+		double step;
+		double time;
+	};
+
+	Header MakeHeader(const int width, const int height, const int tile, const Refine refine)
+	{
+		// Cleared through the padding too, headers are compared as bytes
+		Header header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, "FLIPMAP1", sizeof(header.magic));
+		header.width = width;
+		header.height = height;
+		header.tile = tile;
+		header.check = cfg::flip::CHECK;
+		header.refine = int32_t(refine);
+		header.cell = cfg::flip::CELL;
+		header.buckets = cfg::flip::BUCKETS;
+		header.step = cfg::flip::STEP;
+		header.time = cfg::flip::MAX_TIME;
+		return header;
+	}
+
+	// Quadtree cell by its inclusive corner pixels
+	struct Cell
+	{
+		int x0;
+		int y0;
+		int x1;
+		int y1;
+	};
+
+	enum Known : uint8_t
+	{
+		UNKNOWN,
+		QUEUED,
+		SAMPLED,
+		INTERPOLATED
+	};
+
+	// Flip times coarse enough that neighbours in one bucket look the same
+	int Bucket(const float time)
+	{
+		if (time == FlipMap::NEVER)
+			return -1;
+
+		const double first = cfg::flip::CHECK * cfg::flip::STEP;
+		const double u = std::log(time / first) / std::log(cfg::flip::MAX_TIME / first);
+		return std::clamp(int(u * cfg::flip::BUCKETS), 0, cfg::flip::BUCKETS - 1);
+	}
+
+	// Cell corners along one side, every CELL pixels and the last
+	std::vector<int> Lattice(const int size)
+	{
+		std::vector<int> points;
+
+		for (int i = 0; i < size - 1; i += cfg::flip::CELL)
+			points.push_back(i);
+
+		points.push_back(size - 1);
+		return points;
+	}
+
+	// Pixel centre over [-pi, pi]
+	double Angle(const int i, const int size)
+	{
+		return -PI + (i + 0.5) * 2 * PI / size;
+	}
+}
+
+FlipMap::FlipMap(const int width, const int height, const Refine refine)
+	: m_Width{ width }, m_Height{ height }, m_Tile{}, m_TilesX{}, m_Refine{ refine },
+	m_Samples{ 0 }, m_Times{}, m_Done{}
+{
+	if (width <= 0 || height <= 0)
+		throw std::invalid_argument("Flip map size must be positive.");
+
+	// Quadtree tiles are larger so the coarse lattice is sparse and a tile's samples still fill blocks
+	m_Tile = refine == Refine::Exact ? cfg::flip::TILE : cfg::flip::QUAD;
+	m_TilesX = (width + m_Tile - 1) / m_Tile;
+	const int tiles_y = (height + m_Tile - 1) / m_Tile;
+
+	m_Times.assign(size_t(width) * height, NEVER);
+	m_Done.assign(size_t(m_TilesX) * tiles_y, 0);
+}
+
+bool FlipMap::Integrate(const double* a1, const double* a2, float* times, int8_t* sides, const size_t count,
+						const std::atomic<uint64_t>* generation, const uint64_t expected)
+{
+	// Lowest energy at which link 2 can stand on top, link 1 hanging down and both at rest.
+	// Friction only takes energy away, so anything starting below can never flip.
+	static const double threshold = hamiltonian::Energy(Start(0.0, PI));
+
+	const kernels::Table& table = kernels::Get();
+	Array state[4];
+	uint32_t lane[LANES];
+	size_t active = 0;
+
+	for (Array& a : state)
+		a.assign(LANES, 0.0);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const Vector z = Start(a1[i], a2[i]);
+		times[i] = NEVER;
+
+		if (sides != nullptr)
+			sides[i] = 0;
+
+		if (hamiltonian::Energy(z) < threshold)
+			continue;
+
+		state[0][active] = z[0];
+		state[1][active] = z[1];
+		lane[active++] = uint32_t(i);
+	}
+
+	const int checks = int(cfg::flip::MAX_TIME / (cfg::flip::CHECK * cfg::flip::STEP) + 0.5);
+
+	for (int c = 1; c <= checks && active > 0; c++)
+	{
+		if (generation != nullptr && generation->load(std::memory_order_relaxed) != expected)
+			return false;
+
+		// Only step the blocks still holding live lanes
+		double* const x[4] = { state[0].data(), state[1].data(), state[2].data(), state[3].data() };
+		const size_t size = (active + kernels::BLOCK - 1) / kernels::BLOCK * kernels::BLOCK;
+		table.ensemble_f64(x, size, cfg::flip::STEP, cfg::flip::CHECK);
+
+		const float time = float(c * cfg::flip::CHECK * cfg::flip::STEP);
+		size_t kept = 0;
+
+		// Record the lanes that flipped and pack the rest to the front
+		for (size_t k = 0; k < active; k++)
+		{
+			// Unwrapped absolute angle of link 2 from hanging down
+			const double angle = state[0][k] + state[1][k] + PI / 2;
+
+			if (std::abs(angle) > PI)
+			{
+				times[lane[k]] = time;
+
+				if (sides != nullptr)
+					sides[lane[k]] = angle > 0.0 ? 1 : -1;
+
+				continue;
+			}
+
+			for (Array& a : state)
+				a[kept] = a[k];
+
+			lane[kept++] = lane[k];
+		}
+
+		active = kept;
+	}
+
+	return true;
+}
+
+Vector FlipMap::Start(const double a1, const double a2)
+{
+	// Link 1 from the x axis and link 2 relative to link 1, as the robot has them
+	return Vector{ a1 - PI / 2, a2 - a1, 0.0, 0.0 };
+}
+
+uint32_t FlipMap::Colour(const float time)
+{
+	constexpr size_t stops = std::size(cfg::flip::PALETTE) - 1;
+	const int* rgb = cfg::flip::NEVER_COLOUR;
+	int mixed[3];
+
+	if (time != NEVER)
+	{
+		// Flip times span decades, so blend across the palette by log time
+		const double first = cfg::flip::CHECK * cfg::flip::STEP;
+		const double u = std::clamp(std::log(time / first) / std::log(cfg::flip::MAX_TIME / first), 0.0, 1.0) * stops;
+		const size_t k = std::min(size_t(u), stops - 1);
+		const double f = u - k;
+
+		for (int j = 0; j < 3; j++)
+			mixed[j] = int(cfg::flip::PALETTE[k][j] + f * (cfg::flip::PALETTE[k + 1][j] - cfg::flip::PALETTE[k][j]) + 0.5);
+
+		rgb = mixed;
+	}
+
+	return 0xFF000000u | uint32_t(rgb[0]) << 16 | uint32_t(rgb[1]) << 8 | uint32_t(rgb[2]);
+}
+
+void FlipMap::Generate(Pool& pool, const std::string& checkpoint)
+{
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<uint32_t> todo;
+
+	for (size_t i = 0; i < m_Done.size(); i++)
+	{
+		if (!m_Done[i])
+			todo.push_back(uint32_t(i));
+	}
+
+	// Batches of tiles between checkpoints, enough per worker to balance by stealing
+	const size_t batch = pool.GetSize() * cfg::flip::BATCH;
+	Clock::time_point saved = Clock::now();
+
+	for (size_t begin = 0; begin < todo.size(); begin += batch)
+	{
+		const size_t count = std::min(batch, todo.size() - begin);
+		pool.For(count, [&](const size_t i) { Tile(todo[begin + i]); });
+
+		const Clock::time_point now = Clock::now();
+
+		if (!checkpoint.empty() && std::chrono::duration<double>(now - saved).count() >= cfg::flip::SAVE_TIME)
+		{
+			Save(checkpoint);
+			saved = now;
+		}
+	}
+
+	Mirror();
+
+	if (!checkpoint.empty())
+		Save(checkpoint);
+}
+
+void FlipMap::Tile(const size_t tile)
+{
+	const int x0 = int(tile % m_TilesX) * m_Tile;
+	const int y0 = int(tile / m_TilesX) * m_Tile;
+	const int x1 = std::min(x0 + m_Tile, m_Width);
+	const int y1 = std::min(y0 + m_Tile, m_Height);
+
+	// Mirrored tiles are filled once everything else is done, a quadtree needs two pixels each way
+	if (!IsMirrored(tile))
+	{
+		if (m_Refine == Refine::Quadtree && x1 - x0 > 1 && y1 - y0 > 1)
+			TileQuadtree(x0, y0, x1, y1);
+		else
+			TileExact(x0, y0, x1, y1);
+	}
+
+	m_Done[tile] = 1;
+}
+
+void FlipMap::TileExact(const int x0, const int y0, const int x1, const int y1)
+{
+	double a1[LANES]{};
+	double a2[LANES]{};
+	float times[LANES];
+
+	// Blocks of at most TILE pixels keep each batch within LANES
+	for (int ys = y0; ys < y1; ys += cfg::flip::TILE)
+	{
+		for (int xs = x0; xs < x1; xs += cfg::flip::TILE)
+		{
+			const int xe = std::min(xs + cfg::flip::TILE, x1);
+			const int ye = std::min(ys + cfg::flip::TILE, y1);
+			size_t count = 0;
+
+			for (int y = ys; y < ye; y++)
+			{
+				for (int x = xs; x < xe; x++)
+				{
+					a1[count] = Angle(x, m_Width);
+					a2[count++] = -Angle(y, m_Height);
+				}
+			}
+
+			Integrate(a1, a2, times, nullptr, count);
+			m_Samples.fetch_add(count, std::memory_order_relaxed);
+
+			for (int y = ys, k = 0; y < ye; y++)
+			{
+				for (int x = xs; x < xe; x++)
+					m_Times[size_t(y) * m_Width + x] = times[k++];
+			}
+		}
+	}
+}
+
+void FlipMap::TileQuadtree(const int x0, const int y0, const int x1, const int y1)
+{
+	const int w = x1 - x0;
+	const int h = y1 - y0;
+
+	std::vector<float> times(size_t(w) * h, NEVER);
+	std::vector<int8_t> sides(times.size(), 0);
+	std::vector<uint8_t> known(times.size(), UNKNOWN);
+	std::vector<Cell> cells;
+	std::vector<Cell> next;
+	std::vector<int> queue;
+
+	const std::vector<int> xs = Lattice(w);
+	const std::vector<int> ys = Lattice(h);
+
+	for (size_t j = 0; j + 1 < ys.size(); j++)
+	{
+		for (size_t i = 0; i + 1 < xs.size(); i++)
+			cells.push_back(Cell{ xs[i], ys[j], xs[i + 1], ys[j + 1] });
+	}
+
+	// A cell is judged on a 3 x 3 grid, its corners, edge midpoints and centre, so a band
+	// thinner than the cell passing between the corners is still caught, and the grid
+	// points are the corners of its children should it split
+	int probe[9];
+	int probes;
+
+	const auto Probe = [&](const Cell& c)
+	{
+		const int xs[3] = { c.x0, (c.x0 + c.x1) / 2, c.x1 };
+		const int ys[3] = { c.y0, (c.y0 + c.y1) / 2, c.y1 };
+		probes = 0;
+
+		for (const int y : ys)
+		{
+			for (const int x : xs)
+				probe[probes++] = y * w + x;
+		}
+	};
+
+	// One level of the tree per pass, so every probe of a level goes through the kernel together
+	while (!cells.empty())
+	{
+		queue.clear();
+
+		for (const Cell& c : cells)
+		{
+			Probe(c);
+
+			for (int p = 0; p < probes; p++)
+			{
+				const int k = probe[p];
+
+				if (known[k] == SAMPLED || known[k] == QUEUED)
+					continue;
+
+				known[k] = QUEUED;
+				queue.push_back(k);
+			}
+		}
+
+		for (size_t begin = 0; begin < queue.size(); begin += LANES)
+		{
+			const size_t count = std::min(LANES, queue.size() - begin);
+			double a1[LANES]{};
+			double a2[LANES]{};
+			float t[LANES];
+			int8_t side[LANES];
+
+			for (size_t k = 0; k < count; k++)
+			{
+				const int i = queue[begin + k];
+				a1[k] = Angle(x0 + i % w, m_Width);
+				a2[k] = -Angle(y0 + i / w, m_Height);
+			}
+
+			Integrate(a1, a2, t, side, count);
+			m_Samples.fetch_add(count, std::memory_order_relaxed);
+
+			for (size_t k = 0; k < count; k++)
+			{
+				const int i = queue[begin + k];
+				times[i] = t[k];
+				sides[i] = side[k];
+				known[i] = SAMPLED;
+			}
+		}
+
+		next.clear();
+
+		for (const Cell& c : cells)
+		{
+			const int corner[4] = { c.y0 * w + c.x0, c.y0 * w + c.x1, c.y1 * w + c.x0, c.y1 * w + c.x1 };
+			bool uniform = true;
+			Probe(c);
+
+			for (int p = 1; p < probes; p++)
+			{
+				uniform = uniform
+					&& sides[probe[p]] == sides[corner[0]]
+					&& Bucket(times[probe[p]]) == Bucket(times[corner[0]]);
+			}
+
+			if (uniform)
+			{
+				// Bilinear across the cell, sampled pixels on its edges are kept
+				for (int y = c.y0; y <= c.y1; y++)
+				{
+					const double fy = double(y - c.y0) / (c.y1 - c.y0);
+
+					for (int x = c.x0; x <= c.x1; x++)
+					{
+						const int i = y * w + x;
+
+						if (known[i] == SAMPLED)
+							continue;
+
+						const double fx = double(x - c.x0) / (c.x1 - c.x0);
+						const double top = times[corner[0]] + fx * (times[corner[1]] - times[corner[0]]);
+						const double bottom = times[corner[2]] + fx * (times[corner[3]] - times[corner[2]]);
+
+						times[i] = sides[corner[0]] == 0 ? NEVER : float(top + fy * (bottom - top));
+						sides[i] = sides[corner[0]];
+						known[i] = INTERPOLATED;
+					}
+				}
+
+				continue;
+			}
+
+			// Split in halves along each side still longer than a pixel, cells of only corners are done
+			const int mx = c.x1 - c.x0 > 1 ? (c.x0 + c.x1) / 2 : -1;
+			const int my = c.y1 - c.y0 > 1 ? (c.y0 + c.y1) / 2 : -1;
+
+			if (mx >= 0 && my >= 0)
+			{
+				next.push_back(Cell{ c.x0, c.y0, mx, my });
+				next.push_back(Cell{ mx, c.y0, c.x1, my });
+				next.push_back(Cell{ c.x0, my, mx, c.y1 });
+				next.push_back(Cell{ mx, my, c.x1, c.y1 });
+			}
+			else if (mx >= 0)
+			{
+				next.push_back(Cell{ c.x0, c.y0, mx, c.y1 });
+				next.push_back(Cell{ mx, c.y0, c.x1, c.y1 });
+			}
+			else if (my >= 0)
+			{
+				next.push_back(Cell{ c.x0, c.y0, c.x1, my });
+				next.push_back(Cell{ c.x0, my, c.x1, c.y1 });
+			}
+		}
+
+		cells.swap(next);
+	}
+
+	for (int y = 0; y < h; y++)
+		std::copy_n(&times[size_t(y) * w], w, &m_Times[size_t(y0 + y) * m_Width + x0]);
+}
+
+void FlipMap::Mirror()
+{
+	const size_t last = m_Times.size() - 1;
+
+	for (size_t tile = 0; tile < m_Done.size(); tile++)
+	{
+		if (!IsMirrored(tile))
+			continue;
+
+		const int x0 = int(tile % m_TilesX) * m_Tile;
+		const int y0 = int(tile / m_TilesX) * m_Tile;
+		const int x1 = std::min(x0 + m_Tile, m_Width);
+
+		// Each row of the tile is a reversed run of the image's other half. Kept as a copy
+		// of ranges, GCC 12 at -O2 miscompiled the per-pixel loop and left pixels unset.
+		for (int y = y0; y < std::min(y0 + m_Tile, m_Height); y++)
+		{
+			const size_t begin = size_t(y) * m_Width + x0;
+			const size_t end = size_t(y) * m_Width + x1;
+			std::reverse_copy(m_Times.begin() + (last + 1 - end), m_Times.begin() + (last + 1 - begin), m_Times.begin() + begin);
+		}
+	}
+}
+
+bool FlipMap::IsMirrored(const size_t tile) const
+{
+	// Every pixel of a tile comes after its first, so the whole tile reflects into computed ones
+	const size_t first = size_t(tile / m_TilesX) * m_Tile * m_Width + size_t(tile % m_TilesX) * m_Tile;
+	return 2 * first > m_Times.size() - 1;
+}
+
+bool FlipMap::Load(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+		return false;
+
+	const Header expected = MakeHeader(m_Width, m_Height, m_Tile, m_Refine);
+	Header header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(&header, &expected, sizeof(header)) != 0)
+		throw std::runtime_error("Checkpoint '" + path + "' belongs to a different flip map.");
+
+	file.read(reinterpret_cast<char*>(m_Times.data()), m_Times.size() * sizeof(float));
+	file.read(reinterpret_cast<char*>(m_Done.data()), m_Done.size());
+
+	if (!file)
+		throw std::runtime_error("Checkpoint '" + path + "' is truncated.");
+
+	return true;
+}
+
+void FlipMap::Save(const std::string& path) const
+{
+	// Write beside and swap in, so a run killed mid write leaves the last checkpoint intact
+	const std::string temp = path + ".tmp";
+
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		const Header header = MakeHeader(m_Width, m_Height, m_Tile, m_Refine);
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(m_Times.data()), m_Times.size() * sizeof(float));
+		file.write(reinterpret_cast<const char*>(m_Done.data()), m_Done.size());
+
+		if (!file)
+			throw std::runtime_error("Failed to write checkpoint '" + temp + "'.");
+	}
+
+	std::filesystem::rename(temp, path);
+}
+
+void FlipMap::WritePfm(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	// Negative scale marks little endian, rows run bottom to top
+	file << "Pf\n" << m_Width << ' ' << m_Height << "\n-1.0\n";
+
+	std::vector<float> row(m_Width);
+
+	for (int y = m_Height; y-- > 0;)
+	{
+		for (int x = 0; x < m_Width; x++)
+			row[x] = GetTime(x, y);
+
+		file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+	}
+
+	if (!file)
+		throw std::runtime_error("Failed to write '" + path + "'.");
+}
+
+void FlipMap::WritePpm(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	file << "P6\n" << m_Width << ' ' << m_Height << "\n255\n";
+
+	std::vector<uint8_t> row(size_t(m_Width) * 3);
+
+	for (int y = 0; y < m_Height; y++)
+	{
+		for (int x = 0; x < m_Width; x++)
+		{
+			const uint32_t argb = Colour(GetTime(x, y));
+
+			for (int j = 0; j < 3; j++)
+				row[size_t(x) * 3 + j] = uint8_t(argb >> (16 - 8 * j));
+		}
+
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	if (!file)
+		throw std::runtime_error("Failed to write '" + path + "'.");
+}
+
+bool FlipMap::IsDone() const
+{
+	return GetDoneTiles() == m_Done.size();
+}
+
+size_t FlipMap::GetTiles() const
+{
+	return m_Done.size();
+}
+
+size_t FlipMap::GetDoneTiles() const
+{
+	return size_t(std::count(m_Done.begin(), m_Done.end(), uint8_t(1)));
+}
+
+int FlipMap::GetWidth() const
+{
+	return m_Width;
+}
+
+int FlipMap::GetHeight() const
+{
+	return m_Height;
+}
+
+uint64_t FlipMap::GetSamples() const
+{
+	return m_Samples.load(std::memory_order_relaxed);
+}
+
+float FlipMap::GetTime(const int x, const int y) const
+{
+	return m_Times[size_t(y) * m_Width + x];
+}
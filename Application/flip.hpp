@@ -0,0 +1,89 @@
+#pragma once
+
+#include "pool.hpp"
+#include "config.hpp"
+#include "integrator.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+// How FlipMap::Generate covers each tile
+enum class Refine
+{
+	// Integrate every pixel
+	Exact,
+	// Integrate a lattice of cfg::flip::CELL pixel cells and split only those whose
+	// corners, edge midpoints and centre disagree, interpolating across the rest.
+	// Features narrower than half a cell can fall between those points and be lost.
+	Quadtree
+};
+
+// Time for link 2 to first flip over the top, starting from rest, over a grid
+// of initial angles. Both angles are absolute and measured from hanging straight
+// down, columns sweep link 1 and rows link 2 over [-pi, pi] with +pi on top.
+// Tiles of pixels are stepped as ensemble lanes, each lane dropping out as soon
+// as it flips, and pixels without the energy to ever flip are never integrated.
+// Starting at rest, a point reflection of the angles flips at the same time, so
+// tiles past the middle of the image are copied rather than integrated.
+class FlipMap
+{
+public:
+	// Stored for pixels that do not flip within cfg::flip::MAX_TIME
+	static constexpr float NEVER = -1.0f;
+	// Most pixels integrated together, one tile
+	static constexpr size_t LANES = size_t(cfg::flip::TILE) * cfg::flip::TILE;
+
+	FlipMap(const int width, const int height, const Refine refine = Refine::Quadtree);
+
+	// Flip times of count <= LANES pixels given by their starting angles, and optionally
+	// the sides they went over, +1 anticlockwise, -1 clockwise and 0 never. Returns false,
+	// leaving the output part filled, as soon as generation is no longer expected.
+	static bool Integrate(const double* a1, const double* a2, float* times, int8_t* sides, const size_t count,
+						  const std::atomic<uint64_t>* generation = nullptr, const uint64_t expected = 0);
+	// Robot state at rest for absolute angles from hanging down
+	static Vector Start(const double a1, const double a2);
+	// Opaque ARGB colour for a flip time
+	static uint32_t Colour(const float time);
+
+	// Integrate every unfinished tile, saving to checkpoint every cfg::flip::SAVE_TIME if given
+	void Generate(Pool& pool, const std::string& checkpoint = "");
+
+	// Resume from a checkpoint, false if there is none and throws if it is for another map
+	bool Load(const std::string& path);
+	void Save(const std::string& path) const;
+
+	// Flip times in seconds as a greyscale float image
+	void WritePfm(const std::string& path) const;
+	// Log scaled flip times through cfg::flip::PALETTE
+	void WritePpm(const std::string& path) const;
+
+	bool IsDone() const;
+	size_t GetTiles() const;
+	size_t GetDoneTiles() const;
+	// Pixels integrated rather than interpolated or mirrored by this object's Generate calls
+	uint64_t GetSamples() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	// Seconds until link 2 flips, NEVER if it does not
+	float GetTime(const int x, const int y) const;
+
+private:
+	void Tile(const size_t tile);
+	void TileExact(const int x0, const int y0, const int x1, const int y1);
+	void TileQuadtree(const int x0, const int y0, const int x1, const int y1);
+	// Copy the tiles past the middle from their point reflections
+	void Mirror();
+	bool IsMirrored(const size_t tile) const;
+
+	int m_Width;
+	int m_Height;
+	int m_Tile;
+	int m_TilesX;
+	Refine m_Refine;
+	std::atomic<uint64_t> m_Samples;
+	std::vector<float> m_Times;
+	std::vector<uint8_t> m_Done;
+};
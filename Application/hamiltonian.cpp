@@ -0,0 +1,167 @@
+#include "hamiltonian.hpp"
+#include "dynamics.hpp"
+
+#include <cmath>
+
+
+namespace
+{
+	using namespace dynamics;
+
+	constexpr int MAX_ITERATIONS = 32;
+	constexpr double TOLERANCE = 1e-15;
+
+	// Joint velocities from momenta, w = M(q2)^-1 p
+	void Velocities(const double q2, const double p1, const double p2, double& w1, double& w2)
+	{
+		const double Kc2 = K * cos(q2);
+		const double M11 = M11_0 + 2 * Kc2;
+		const double M12 = M22 + Kc2;
+		const double inv = 1.0 / (D0 - Kc2 * Kc2);
+
+		w1 = (M22 * p1 - M12 * p2) * inv;
+		w2 = (M11 * p2 - M12 * p1) * inv;
+	}
+
+	// Generalised force -dH/dq plus joint friction
+	void Forces(const double q1, const double q2, const double w1, const double w2, double& f1, double& f2)
+	{
+		const double c12 = cos(q1 + q2);
+
+		f1 = -G1_0 * cos(q1) - G2_0 * c12 - u1 * w1;
+		f2 = -G2_0 * c12 - K * sin(q2) * w1 * (w1 + w2) - u2 * w2;
+	}
+
+	bool Converged(const double a, const double b)
+	{
+		return fabs(a - b) <= TOLERANCE * (1.0 + fabs(a));
+	}
+}
+
+namespace hamiltonian
+{
+	Vector ToCanonical(const Vector& x)
+	{
+		const double Kc2 = K * cos(x[1]);
+		const double M11 = M11_0 + 2 * Kc2;
+		const double M12 = M22 + Kc2;
+
+		return Vector{ x[0], x[1], M11 * x[2] + M12 * x[3], M12 * x[2] + M22 * x[3] };
+	}
+
+	Vector FromCanonical(const Vector& z)
+	{
+		double w1, w2;
+		Velocities(z[1], z[2], z[3], w1, w2);
+
+		return Vector{ z[0], z[1], w1, w2 };
+	}
+
+	double Energy(const Vector& z)
+	{
+		double w1, w2;
+		Velocities(z[1], z[2], z[3], w1, w2);
+
+		const double kinetic = 0.5 * (z[2] * w1 + z[3] * w2);
+		const double potential = G1_0 * sin(z[0]) + G2_0 * sin(z[0] + z[1]);
+
+		return kinetic + potential;
+	}
+
+	Vector Flow(const Vector& z)
+	{
+		double w1, w2, f1, f2;
+		Velocities(z[1], z[2], z[3], w1, w2);
+		Forces(z[0], z[1], w1, w2, f1, f2);
+
+		return Vector{ w1, w2, f1, f2 };
+	}
+}
+
+namespace symplectic
+{
+	Vector Verlet::Step(const Vector& z, const double h)
+	{
+		const double q1 = z[0];
+		const double q2 = z[1];
+		double w1, w2, f1, f2;
+
+		// Half kick, implicit in the momenta
+		double p1 = z[2];
+		double p2 = z[3];
+
+		for (int i = 0; i < MAX_ITERATIONS; i++)
+		{
+			Velocities(q2, p1, p2, w1, w2);
+			Forces(q1, q2, w1, w2, f1, f2);
+
+			const double n1 = z[2] + 0.5 * h * f1;
+			const double n2 = z[3] + 0.5 * h * f2;
+			const bool done = Converged(n1, p1) && Converged(n2, p2);
+			p1 = n1;
+			p2 = n2;
+
+			if (done)
+				break;
+		}
+
+		// Drift, implicit in the positions
+		double v1, v2;
+		Velocities(q2, p1, p2, v1, v2);
+
+		double r1 = q1 + h * v1;
+		double r2 = q2 + h * v2;
+
+		for (int i = 0; i < MAX_ITERATIONS; i++)
+		{
+			Velocities(r2, p1, p2, w1, w2);
+
+			const double n1 = q1 + 0.5 * h * (v1 + w1);
+			const double n2 = q2 + 0.5 * h * (v2 + w2);
+			const bool done = Converged(n1, r1) && Converged(n2, r2);
+			r1 = n1;
+			r2 = n2;
+
+			if (done)
+				break;
+		}
+
+		// Half kick, explicit
+		Velocities(r2, p1, p2, w1, w2);
+		Forces(r1, r2, w1, w2, f1, f2);
+
+		return Vector{ r1, r2, p1 + 0.5 * h * f1, p2 + 0.5 * h * f2 };
+	}
+
+	Vector Midpoint::Step(const Vector& z, const double h)
+	{
+		Vector y = z;
+		const Vector dz = hamiltonian::Flow(z);
+
+		for (int n = 0; n < 4; n++)
+			y[n] += h * dz[n];
+
+		for (int i = 0; i < MAX_ITERATIONS; i++)
+		{
+			Vector m;
+
+			for (int n = 0; n < 4; n++)
+				m[n] = 0.5 * (z[n] + y[n]);
+
+			const Vector f = hamiltonian::Flow(m);
+			bool done = true;
+
+			for (int n = 0; n < 4; n++)
+			{
+				const double next = z[n] + h * f[n];
+				done = done && Converged(next, y[n]);
+				y[n] = next;
+			}
+
+			if (done)
+				break;
+		}
+
+		return y;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "config.hpp"
+#include "integrator.hpp"
+
+
+// Canonical formulation with state packed as { q1, q2, p1, p2 }
+namespace hamiltonian
+{
+	Vector ToCanonical(const Vector& x);
+	Vector FromCanonical(const Vector& z);
+	double Energy(const Vector& z);
+	Vector Flow(const Vector& z);
+}
+
+// Symplectic integrators on the canonical state
+namespace symplectic
+{
+	// Generalised leapfrog, implicit in the non-separable terms
+	struct Verlet
+	{
+		static Vector Step(const Vector& z, const double h);
+	};
+
+	// Symmetric triple-jump composition raising the order by two
+	template <class Base, class Weights>
+	struct Composition
+	{
+		static Vector Step(const Vector& z, const double h)
+		{
+			Vector y = Base::Step(z, Weights::OUTER * h);
+			y = Base::Step(y, Weights::INNER * h);
+			return Base::Step(y, Weights::OUTER * h);
+		}
+	};
+
+	// Yoshida's weights 1 / (2 - 2^(1/(k+1))) for a base method of order k
+	namespace weights
+	{
+		struct Order4
+		{
+			static constexpr double OUTER = 1.3512071919596578;
+			static constexpr double INNER = -1.7024143839193155;
+		};
+
+		struct Order6
+		{
+			static constexpr double OUTER = 1.1746717580893635;
+			static constexpr double INNER = -1.349343516178727;
+		};
+	}
+
+	using Yoshida4 = Composition<Verlet, weights::Order4>;
+	using Yoshida6 = Composition<Yoshida4, weights::Order6>;
+
+	// Implicit midpoint rule on the full vector field
+	struct Midpoint
+	{
+		static Vector Step(const Vector& z, const double h);
+	};
+}
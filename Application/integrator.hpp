@@ -0,0 +1,442 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+// Joint state packed as { q1, q2, w1, w2 }
+using Vector = std::array<double, 4>;
+// Row-major 4x4 matrix, e.g. the Jacobian of the joint state derivative
+using Matrix = std::array<Vector, 4>;
+
+// Fixed-step explicit integrators as compile-time policies
+namespace integrator
+{
+	// Generic explicit Runge-Kutta step over a Butcher tableau
+	template <class Tableau>
+	struct Explicit
+	{
+		static constexpr int STAGES = Tableau::STAGES;
+
+		template <class F>
+		static Vector Step(F&& f, const Vector& x, const double h, Vector& dx)
+		{
+			Vector k[STAGES];
+			k[0] = f(x);
+
+			for (int i = 1; i < STAGES; i++)
+			{
+				Vector y = x;
+
+				for (int j = 0; j < i; j++)
+				{
+					if (Tableau::A[i][j] == 0.0)
+						continue;
+
+					const double a = h * Tableau::A[i][j];
+
+					for (int n = 0; n < 4; n++)
+						y[n] += a * k[j][n];
+				}
+
+				k[i] = f(y);
+			}
+
+			Vector y = x;
+
+			for (int i = 0; i < STAGES; i++)
+			{
+				if (Tableau::B[i] == 0.0)
+					continue;
+
+				const double b = h * Tableau::B[i];
+
+				for (int n = 0; n < 4; n++)
+					y[n] += b * k[i][n];
+			}
+
+			dx = k[0];
+			return y;
+		}
+	};
+
+	namespace tableau
+	{
+		// First-order forward Euler
+		struct Euler
+		{
+			static constexpr int STAGES = 1;
+			static constexpr double A[1][1] = { { 0.0 } };
+			static constexpr double B[1] = { 1.0 };
+		};
+
+		// Classic fourth-order Runge-Kutta
+		struct RK4
+		{
+			static constexpr int STAGES = 4;
+			static constexpr double A[4][4] =
+			{
+				{ 0.0, 0.0, 0.0, 0.0 },
+				{ 1.0 / 2, 0.0, 0.0, 0.0 },
+				{ 0.0, 1.0 / 2, 0.0, 0.0 },
+				{ 0.0, 0.0, 1.0, 0.0 }
+			};
+			static constexpr double B[4] = { 1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6 };
+		};
+
+		// Kutta's fourth-order 3/8 rule
+		struct RK38
+		{
+			static constexpr int STAGES = 4;
+			static constexpr double A[4][4] =
+			{
+				{ 0.0, 0.0, 0.0, 0.0 },
+				{ 1.0 / 3, 0.0, 0.0, 0.0 },
+				{ -1.0 / 3, 1.0, 0.0, 0.0 },
+				{ 1.0, -1.0, 1.0, 0.0 }
+			};
+			static constexpr double B[4] = { 1.0 / 8, 3.0 / 8, 3.0 / 8, 1.0 / 8 };
+		};
+
+		// Butcher's seven-stage sixth-order method
+		struct RK6
+		{
+			static constexpr int STAGES = 7;
+			static constexpr double A[7][7] =
+			{
+				{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+				{ 1.0 / 3, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+				{ 0.0, 2.0 / 3, 0.0, 0.0, 0.0, 0.0, 0.0 },
+				{ 1.0 / 12, 1.0 / 3, -1.0 / 12, 0.0, 0.0, 0.0, 0.0 },
+				{ -1.0 / 16, 9.0 / 8, -3.0 / 16, -3.0 / 8, 0.0, 0.0, 0.0 },
+				{ 0.0, 9.0 / 8, -3.0 / 8, -3.0 / 4, 1.0 / 2, 0.0, 0.0 },
+				{ 9.0 / 44, -9.0 / 11, 63.0 / 44, 18.0 / 11, 0.0, -16.0 / 11, 0.0 }
+			};
+			static constexpr double B[7] =
+			{
+				11.0 / 120, 0.0, 27.0 / 40, 27.0 / 40, -4.0 / 15, -4.0 / 15, 11.0 / 120
+			};
+		};
+	}
+
+	using Euler = Explicit<tableau::Euler>;
+	using RK4 = Explicit<tableau::RK4>;
+	using RK38 = Explicit<tableau::RK38>;
+	using RK6 = Explicit<tableau::RK6>;
+
+	// Adaptive Dormand-Prince 5(4) pair with PI step control and dense output
+	class DormandPrince
+	{
+	public:
+		DormandPrince(const double rtol = cfg::sim::RTOL, const double atol = cfg::sim::ATOL)
+			: m_RelTol{ rtol }, m_AbsTol{ atol }, m_X{}, m_Dx{}, m_X0{}, m_Cont{},
+			m_Time{}, m_Time0{}, m_Step{}, m_PrevError{ 1e-4 },
+			m_Accepted{}, m_Rejected{}, m_Started{ false }
+		{
+		}
+
+		void Reset(const Vector& x, const double t)
+		{
+			m_X = x;
+			m_X0 = x;
+			m_Time = t;
+			m_Time0 = t;
+			m_Step = 0.0;
+			m_PrevError = 1e-4;
+			m_Started = false;
+
+			for (Vector& r : m_Cont)
+				r = Vector{};
+		}
+
+		// Take one accepted step, retrying with smaller sizes on rejection. Returns
+		// false, leaving the state where it was, once the error is not finite or the
+		// step has shrunk below rounding at the current time, as no retry could pass.
+		template <class F>
+		bool Step(F&& f)
+		{
+			if (!m_Started)
+			{
+				m_Dx = f(m_X);
+				m_Step = InitialStep();
+				m_Started = true;
+			}
+
+			Vector k[7];
+			k[0] = m_Dx;
+
+			while (true)
+			{
+				const double h = m_Step;
+
+				for (int i = 1; i < 7; i++)
+				{
+					Vector y = m_X;
+
+					for (int j = 0; j < i; j++)
+					{
+						if (A[i][j] == 0.0)
+							continue;
+
+						for (int n = 0; n < 4; n++)
+							y[n] += h * A[i][j] * k[j][n];
+					}
+
+					k[i] = f(y);
+				}
+
+				// Stage seven is evaluated at the new solution (FSAL)
+				Vector y = m_X;
+
+				for (int n = 0; n < 4; n++)
+					y[n] += h * (A[6][0] * k[0][n] + A[6][2] * k[2][n] + A[6][3] * k[3][n] + A[6][4] * k[4][n] + A[6][5] * k[5][n]);
+
+				double error = 0.0;
+
+				for (int n = 0; n < 4; n++)
+				{
+					double e = 0.0;
+
+					for (int i = 0; i < 7; i++)
+						e += E[i] * k[i][n];
+
+					const double scale = m_AbsTol + m_RelTol * std::max(std::fabs(m_X[n]), std::fabs(y[n]));
+					error += (h * e / scale) * (h * e / scale);
+				}
+
+				error = std::sqrt(error / 4);
+
+				if (!std::isfinite(error))
+					return false;
+
+				// PI controller after Hairer, Norsett & Wanner
+				const double fac11 = std::pow(error, 0.2 - BETA * 0.75);
+
+				if (error <= 1.0)
+				{
+					double fac = fac11 / std::pow(m_PrevError, BETA) / SAFETY;
+					fac = std::max(1.0 / MAX_FACTOR, std::min(1.0 / MIN_FACTOR, fac));
+					m_PrevError = std::max(error, 1e-4);
+
+					for (int n = 0; n < 4; n++)
+					{
+						const double diff = y[n] - m_X[n];
+						const double spline = h * k[0][n] - diff;
+						m_Cont[0][n] = m_X[n];
+						m_Cont[1][n] = diff;
+						m_Cont[2][n] = spline;
+						m_Cont[3][n] = diff - h * k[6][n] - spline;
+						m_Cont[4][n] = 0.0;
+
+						for (int i = 0; i < 7; i++)
+							m_Cont[4][n] += h * D[i] * k[i][n];
+					}
+
+					m_X0 = m_X;
+					m_Time0 = m_Time;
+					m_X = y;
+					m_Dx = k[6];
+					m_Time += h;
+					m_Step = std::min(h / fac, cfg::sim::MAX_STEP);
+					m_Accepted++;
+					return true;
+				}
+
+				m_Step = h / std::min(1.0 / MIN_FACTOR, fac11 / SAFETY);
+				m_Rejected++;
+
+				if (m_Step <= MIN_STEP_ULPS * std::numeric_limits<double>::epsilon() * std::max(1.0, std::fabs(m_Time)))
+					return false;
+			}
+		}
+
+		// Continuous extension over the last accepted step
+		Vector Sample(const double t) const
+		{
+			const double h = m_Time - m_Time0;
+
+			if (h <= 0.0)
+				return m_X;
+
+			const double theta = (t - m_Time0) / h;
+			const double theta1 = 1.0 - theta;
+			Vector y;
+
+			for (int n = 0; n < 4; n++)
+				y[n] = m_Cont[0][n] + theta * (m_Cont[1][n] + theta1 * (m_Cont[2][n] + theta * (m_Cont[3][n] + theta1 * m_Cont[4][n])));
+
+			return y;
+		}
+
+		// Time derivative of the continuous extension
+		Vector SampleDerivative(const double t) const
+		{
+			const double h = m_Time - m_Time0;
+
+			if (h <= 0.0)
+				return m_Dx;
+
+			const double theta = (t - m_Time0) / h;
+			const double theta1 = 1.0 - theta;
+			Vector dy;
+
+			for (int n = 0; n < 4; n++)
+			{
+				const double p = m_Cont[2][n] + theta * (m_Cont[3][n] + theta1 * m_Cont[4][n]);
+				const double dp = m_Cont[3][n] + (1.0 - 2.0 * theta) * m_Cont[4][n];
+				const double q = m_Cont[1][n] + theta1 * p;
+				const double dq = -p + theta1 * dp;
+				dy[n] = (q + theta * dq) / h;
+			}
+
+			return dy;
+		}
+
+		double GetTime() const { return m_Time; }
+		double GetStartTime() const { return m_Time0; }
+		double GetStepSize() const { return m_Step; }
+		const Vector& GetState() const { return m_X; }
+		const Vector& GetDerivative() const { return m_Dx; }
+		long long GetAccepted() const { return m_Accepted; }
+		long long GetRejected() const { return m_Rejected; }
+
+	private:
+		double InitialStep() const
+		{
+			double d0 = 0.0;
+			double d1 = 0.0;
+
+			for (int n = 0; n < 4; n++)
+			{
+				const double scale = m_AbsTol + m_RelTol * std::fabs(m_X[n]);
+				d0 += (m_X[n] / scale) * (m_X[n] / scale);
+				d1 += (m_Dx[n] / scale) * (m_Dx[n] / scale);
+			}
+
+			d0 = std::sqrt(d0 / 4);
+			d1 = std::sqrt(d1 / 4);
+
+			const double h = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+			return std::min(h, cfg::sim::MAX_STEP);
+		}
+
+		static constexpr double SAFETY = 0.9;
+		static constexpr double BETA = 0.04;
+		static constexpr double MIN_FACTOR = 0.2;
+		static constexpr double MAX_FACTOR = 10.0;
+		// Smallest step in units of the spacing of doubles around the current time
+		static constexpr double MIN_STEP_ULPS = 16.0;
+
+		static constexpr double A[7][6] =
+		{
+			{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+			{ 1.0 / 5, 0.0, 0.0, 0.0, 0.0, 0.0 },
+			{ 3.0 / 40, 9.0 / 40, 0.0, 0.0, 0.0, 0.0 },
+			{ 44.0 / 45, -56.0 / 15, 32.0 / 9, 0.0, 0.0, 0.0 },
+			{ 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729, 0.0, 0.0 },
+			{ 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656, 0.0 },
+			{ 35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 }
+		};
+		static constexpr double E[7] =
+		{
+			71.0 / 57600, 0.0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40
+		};
+		static constexpr double D[7] =
+		{
+			-12715105075.0 / 11282082432, 0.0, 87487479700.0 / 32700410799, -10690763975.0 / 1880347072,
+			701980252875.0 / 199316789632, -1453857185.0 / 822651844, 69997945.0 / 29380423
+		};
+
+		double m_RelTol;
+		double m_AbsTol;
+		Vector m_X;
+		Vector m_Dx;
+		Vector m_X0;
+		Vector m_Cont[5];
+		double m_Time;
+		double m_Time0;
+		double m_Step;
+		double m_PrevError;
+		long long m_Accepted;
+		long long m_Rejected;
+		bool m_Started;
+	};
+
+	// Solves the implicit stage y = z + c f(y) of a second-order system.
+	// Because dq/dt = w, the positions follow from the velocities as
+	// q = z_q + c w, which reduces Newton's method to a 2x2 solve in w
+	// with iteration matrix I - c df_w/dw - c^2 df_w/dq.
+	template <class F, class J>
+	Vector SolveStage(F&& f, J&& jacobian, const Vector& z, const double c, Vector& dy)
+	{
+		constexpr int MAX_ITERATIONS = 16;
+		constexpr double TOLERANCE = 1e-13;
+
+		// Explicit predictor
+		dy = f(z);
+		double w1 = z[2] + c * dy[2];
+		double w2 = z[3] + c * dy[3];
+
+		for (int i = 0; i < MAX_ITERATIONS; i++)
+		{
+			const Vector y{ z[0] + c * w1, z[1] + c * w2, w1, w2 };
+			const Matrix jac = jacobian(y);
+			dy = f(y);
+
+			const double r1 = w1 - z[2] - c * dy[2];
+			const double r2 = w2 - z[3] - c * dy[3];
+			const double n11 = 1.0 - c * jac[2][2] - c * c * jac[2][0];
+			const double n12 = -c * jac[2][3] - c * c * jac[2][1];
+			const double n21 = -c * jac[3][2] - c * c * jac[3][0];
+			const double n22 = 1.0 - c * jac[3][3] - c * c * jac[3][1];
+			const double det = n11 * n22 - n12 * n21;
+			const double d1 = (n22 * r1 - n12 * r2) / det;
+			const double d2 = (n11 * r2 - n21 * r1) / det;
+
+			w1 -= d1;
+			w2 -= d2;
+
+			if (std::fabs(d1) <= TOLERANCE * (1.0 + std::fabs(w1)) && std::fabs(d2) <= TOLERANCE * (1.0 + std::fabs(w2)))
+				break;
+		}
+
+		const Vector y{ z[0] + c * w1, z[1] + c * w2, w1, w2 };
+		dy = f(y);
+		return y;
+	}
+
+	// First-order, L-stable backward Euler
+	struct BackwardEuler
+	{
+		template <class F, class J>
+		static Vector Step(F&& f, J&& jacobian, const Vector& x, const double h, Vector& dx)
+		{
+			return SolveStage(f, jacobian, x, h, dx);
+		}
+	};
+
+	// Alexander's two-stage, second-order, L-stable SDIRK
+	struct SDIRK2
+	{
+		template <class F, class J>
+		static Vector Step(F&& f, J&& jacobian, const Vector& x, const double h, Vector& dx)
+		{
+			constexpr double GAMMA = 1.0 - 0.70710678118654752;
+
+			Vector k1;
+			SolveStage(f, jacobian, x, GAMMA * h, k1);
+
+			Vector z = x;
+
+			for (int n = 0; n < 4; n++)
+				z[n] += (1.0 - GAMMA) * h * k1[n];
+
+			// Stiffly accurate, so the second stage is the solution
+			return SolveStage(f, jacobian, z, GAMMA * h, dx);
+		}
+	};
+}
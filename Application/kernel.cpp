@@ -0,0 +1,144 @@
+#include "kernel.hpp"
+#include "config.hpp"
+
+// Headless builds go without SDL and ask the CPU directly
+#ifdef PENDULUM_HEADLESS
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#else
+#include "SDL_cpuinfo.h"
+#endif
+
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+
+namespace kernels
+{
+	namespace
+	{
+		const Table& Lookup(const Level level)
+		{
+			switch (level)
+			{
+			case Level::AVX512:
+				return AVX512;
+			case Level::AVX2:
+				return AVX2;
+			default:
+				return SSE2;
+			}
+		}
+
+		// Startup selection, honouring the environment override
+		const Table* Select()
+		{
+			const char* name = std::getenv(cfg::cpu::ISA_OVERRIDE);
+			Level level = Detect();
+
+			if (name != nullptr && *name != '\0')
+			{
+				if (!Parse(name, level))
+					throw std::runtime_error(std::string("Unknown ISA level ") + name + ".");
+				if (level > Detect())
+					throw std::runtime_error(std::string("This CPU does not support ") + GetName(level) + ".");
+			}
+
+			return &Lookup(level);
+		}
+
+		std::atomic<const Table*>& Active()
+		{
+			static std::atomic<const Table*> active{ Select() };
+			return active;
+		}
+	}
+
+	Level Detect()
+	{
+#ifndef PENDULUM_HEADLESS
+		// SDL also checks the OS saves the wider register state
+		if (SDL_HasAVX512F())
+			return Level::AVX512;
+		if (SDL_HasAVX2())
+			return Level::AVX2;
+#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int leaves = info[0];
+		__cpuid(info, 1);
+
+		// The OS must save the wider registers, YMM for AVX2 and also the mask and ZMM for AVX-512
+		if (leaves < 7 || (info[2] & (1 << 27)) == 0)
+			return Level::SSE2;
+
+		const unsigned long long xcr0 = _xgetbv(0);
+		__cpuidex(info, 7, 0);
+
+		if ((xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0)
+			return Level::AVX512;
+		if ((xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0)
+			return Level::AVX2;
+#else
+		// GCC and Clang check the OS register state as SDL does
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx512f"))
+			return Level::AVX512;
+		if (__builtin_cpu_supports("avx2"))
+			return Level::AVX2;
+#endif
+
+		return Level::SSE2;
+	}
+
+	const Table& Get()
+	{
+		return *Active().load(std::memory_order_acquire);
+	}
+
+	void Force(const Level level)
+	{
+		if (level > Detect())
+			throw std::runtime_error(std::string("This CPU does not support ") + GetName(level) + ".");
+
+		Active().store(&Lookup(level), std::memory_order_release);
+	}
+
+	bool Parse(const char* name, Level& level)
+	{
+		std::string s(name);
+
+		for (char& c : s)
+			c = (char)std::tolower((unsigned char)c);
+
+		if (s == "sse2")
+			level = Level::SSE2;
+		else if (s == "avx2")
+			level = Level::AVX2;
+		else if (s == "avx512" || s == "avx-512")
+			level = Level::AVX512;
+		else
+			return false;
+
+		return true;
+	}
+
+	const char* GetName(const Level level)
+	{
+		switch (level)
+		{
+		case Level::AVX512:
+			return "AVX-512";
+		case Level::AVX2:
+			return "AVX2";
+		default:
+			return "SSE2";
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+
+// Ensemble stepping kernels compiled once per ISA level and selected at startup.
+// The single Robot stays on its inlined scalar path, being latency bound on two
+// sincos calls it gained nothing from wider builds and lost the inlining.
+namespace kernels
+{
+	enum class Level
+	{
+		SSE2,
+		AVX2,
+		AVX512
+	};
+
+	// Ensemble sizes are padded to whole blocks, a multiple of every level's interleaved width
+	constexpr size_t BLOCK = 32;
+
+	struct Table
+	{
+		Level level;
+		size_t width_f64;
+		size_t width_f32;
+		// RK4 steps over size lanes of { q1, q2, w1, w2 } arrays, size a multiple of BLOCK
+		void (*ensemble_f64)(double* const state[4], size_t size, double h, int steps);
+		void (*ensemble_f32)(float* const state[4], size_t size, double h, int steps);
+		// Same with the 16 tangent components, column major, orthonormalised every renorm
+		// steps and after the last, adding the log stretches to sums
+		void (*lyapunov_f64)(double* const state[4], double* const tangent[16], double* const sums[4],
+							 size_t size, double h, int steps, int renorm);
+	};
+
+	// Defined in Sse2.cpp, Avx2.cpp and Avx512.cpp, each built with its own /arch
+	extern const Table SSE2;
+	extern const Table AVX2;
+	extern const Table AVX512;
+
+	// Highest level this machine supports
+	Level Detect();
+	// Active table, the detected level unless overridden
+	const Table& Get();
+	// Force a level, throws if the machine cannot run it
+	void Force(const Level level);
+	bool Parse(const char* name, Level& level);
+	const char* GetName(const Level level);
+}
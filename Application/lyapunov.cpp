@@ -0,0 +1,114 @@
+#include "lyapunov.hpp"
+#include "kernel.hpp"
+
+#include <algorithm>
+
+
+Lyapunov::Lyapunov(const size_t size)
+	: m_Size{ size }, m_Time{ 0.0 }
+{
+	// Round up to whole blocks like Ensemble, spare lanes hold a resting pendulum
+	const size_t padded = (size + kernels::BLOCK - 1) / kernels::BLOCK * kernels::BLOCK;
+
+	for (Array& a : m_State)
+		a.assign(padded, 0.0);
+
+	for (int k = 0; k < 16; k++)
+		m_Tangent[k].assign(padded, k % 5 == 0 ? 1.0 : 0.0);
+
+	for (Array& a : m_Sums)
+		a.assign(padded, 0.0);
+}
+
+void Lyapunov::Update(const double dt, const int steps)
+{
+	double* const state[4] = { m_State[0].data(), m_State[1].data(), m_State[2].data(), m_State[3].data() };
+	double* tangent[16];
+	double* const sums[4] = { m_Sums[0].data(), m_Sums[1].data(), m_Sums[2].data(), m_Sums[3].data() };
+
+	for (int k = 0; k < 16; k++)
+		tangent[k] = m_Tangent[k].data();
+
+	kernels::Get().lyapunov_f64(state, tangent, sums, m_State[0].size(), dt, steps, cfg::lyapunov::RENORM);
+	m_Time += dt * steps;
+}
+
+void Lyapunov::Update(const double dt, const int steps, Pool& pool)
+{
+	static_assert(cfg::pool::CHUNK % kernels::BLOCK == 0, "Chunks must hold whole blocks");
+
+	const size_t size = m_State[0].size();
+	const size_t chunks = (size + cfg::pool::CHUNK - 1) / cfg::pool::CHUNK;
+	const kernels::Table& table = kernels::Get();
+
+	pool.For(chunks, [&](const size_t i)
+	{
+		const size_t begin = i * cfg::pool::CHUNK;
+		const size_t count = std::min(cfg::pool::CHUNK, size - begin);
+		double* state[4];
+		double* tangent[16];
+		double* sums[4];
+
+		for (int j = 0; j < 4; j++)
+		{
+			state[j] = m_State[j].data() + begin;
+			sums[j] = m_Sums[j].data() + begin;
+		}
+
+		for (int k = 0; k < 16; k++)
+			tangent[k] = m_Tangent[k].data() + begin;
+
+		table.lyapunov_f64(state, tangent, sums, count, dt, steps, cfg::lyapunov::RENORM);
+	});
+
+	m_Time += dt * steps;
+}
+
+void Lyapunov::Restart()
+{
+	// The tangents are left orthonormal by the last Update, so only the averages start over
+	for (Array& a : m_Sums)
+		std::fill(a.begin(), a.end(), 0.0);
+
+	m_Time = 0.0;
+}
+
+void Lyapunov::Set(const size_t i, const Vector& x)
+{
+	for (int j = 0; j < 4; j++)
+	{
+		m_State[j][i] = x[j];
+		m_Sums[j][i] = 0.0;
+	}
+
+	for (int k = 0; k < 16; k++)
+		m_Tangent[k][i] = k % 5 == 0 ? 1.0 : 0.0;
+}
+
+Vector Lyapunov::Get(const size_t i) const
+{
+	return Vector{ m_State[0][i], m_State[1][i], m_State[2][i], m_State[3][i] };
+}
+
+Lyapunov::Spectrum Lyapunov::GetSpectrum(const size_t i) const
+{
+	Spectrum spectrum{};
+
+	if (m_Time > 0.0)
+	{
+		for (int j = 0; j < 4; j++)
+			spectrum[j] = m_Sums[j][i] / m_Time;
+	}
+
+	return spectrum;
+}
+
+size_t Lyapunov::GetSize() const
+{
+	return m_Size;
+}
+
+double Lyapunov::GetTime() const
+{
+	return m_Time;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "pool.hpp"
+#include "simd.hpp"
+#include "config.hpp"
+#include "integrator.hpp"
+
+#include <array>
+#include <vector>
+
+
+// Lyapunov spectra of independent double pendulums. Each lane carries four
+// tangent vectors through the variational equations, stepped with RK4 alongside
+// the state on the analytic Jacobian of the dynamics and orthonormalised every
+// cfg::lyapunov::RENORM steps. The exponents are the average log stretch of each
+// vector, so a whole grid of initial conditions is mapped in one pass.
+class Lyapunov
+{
+public:
+	using Array = std::vector<double, simd::Allocator<double>>;
+	using Spectrum = std::array<double, 4>;
+
+	Lyapunov(const size_t size);
+
+	void Update(const double dt, const int steps = 1);
+	// Same, with cfg::pool::CHUNK lane chunks spread over the pool
+	void Update(const double dt, const int steps, Pool& pool);
+	// Average from here on, dropping the transient so far
+	void Restart();
+
+	// Start pendulum i from x with the standard basis as tangents, before the first Update
+	void Set(const size_t i, const Vector& x);
+	Vector Get(const size_t i) const;
+	// Exponents in 1/s in Gram-Schmidt order, which settles to largest first
+	Spectrum GetSpectrum(const size_t i) const;
+
+	size_t GetSize() const;
+	double GetTime() const;
+
+private:
+	size_t m_Size;
+	double m_Time;
+	Array m_State[4];
+	Array m_Tangent[16];
+	Array m_Sums[4];
+};
@@ -1,31 +1,571 @@
-#include "Window.hpp"
+// Define PENDULUM_HEADLESS to build only the commands below that need no SDL,
+// as the CMake build does for machines without a display
+#ifndef PENDULUM_HEADLESS
+// SDL must not rename main, the entry points below are our own
+#define SDL_MAIN_HANDLED
 
+#include "window.hpp"
+#endif
+
+#include "flip.hpp"
+#include "robot.hpp"
+#include "lyapunov.hpp"
+#include "section.hpp"
+
+#if defined(_WIN32) && !defined(PENDULUM_HEADLESS)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#endif
 
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <fstream>
 #include <exception>
+#include <stdexcept>
+#include <filesystem>
 
-#define ErrorBox(msg) MessageBoxA(NULL, msg, "Error", MB_ICONERROR | MB_OK)
 
+// Arguments after the command, one per argv entry so values may hold spaces
+using Args = std::vector<std::string>;
+
+// The whole of text as a value of type T
+template <class T>
+static bool Parse(const std::string& text, T& value)
+{
+	std::istringstream stream(text);
+	return stream >> value && stream.peek() == std::char_traits<char>::eof();
+}
+
+// "--name value" pairs following a command
+class Options
+{
+public:
+	Options(const Args& args)
+	{
+		for (size_t i = 0; i < args.size(); i += 2)
+		{
+			if (args[i].rfind("--", 0) != 0 || i + 1 == args.size())
+				throw std::invalid_argument("Expected '--name value' but got '" + args[i] + "'.");
+
+			m_Values[args[i].substr(2)] = args[i + 1];
+		}
+	}
+
+	double Number(const std::string& name, const double fallback) const
+	{
+		const std::string text = Text(name, "");
+
+		if (text.empty())
+			return fallback;
+
+		size_t end = 0;
+		double value = 0.0;
+
+		try
+		{
+			value = std::stod(text, &end);
+		}
+		catch (const std::logic_error&)
+		{
+			end = 0;
+		}
+
+		// Out of range, nan and inf are refused along with any trailing text
+		if (end != text.size() || !std::isfinite(value))
+			throw std::invalid_argument("Option --" + name + " takes a number, not '" + text + "'.");
+
+		return value;
+	}
+
+	// A whole number in [low, high], checked before it is cast
+	long long Integer(const std::string& name, const long long fallback, const long long low, const long long high) const
+	{
+		const double value = Number(name, double(fallback));
+
+		if (value != std::floor(value) || value < double(low) || value > double(high))
+			throw std::invalid_argument("Option --" + name + " takes a whole number from "
+				+ std::to_string(low) + " to " + std::to_string(high) + ".");
+
+		return (long long)value;
+	}
+
+	std::string Text(const std::string& name, const std::string& fallback) const
+	{
+		m_Used.insert(name);
+		const auto it = m_Values.find(name);
+		return it == m_Values.end() ? fallback : it->second;
+	}
+
+	bool Has(const std::string& name) const
+	{
+		m_Used.insert(name);
+		return m_Values.count(name) > 0;
+	}
+
+	// Catch misspelt options rather than silently running the defaults
+	void Finish() const
+	{
+		for (const auto& [name, value] : m_Values)
+			if (m_Used.count(name) == 0)
+				throw std::invalid_argument("Unknown option --" + name + ".");
+	}
+
+private:
+	std::map<std::string, std::string> m_Values;
+	mutable std::set<std::string> m_Used;
+};
+
+// Robot and its run time after a headless run
+struct Result
+{
+	Robot robot;
+	long long steps;
+	double seconds;
+};
+
+static constexpr struct
+{
+	const char* name;
+	Method method;
+}
+METHODS[] =
+{
+	{ "euler", Method::Euler },
+	{ "rk4", Method::RK4 },
+	{ "rk38", Method::RK38 },
+	{ "rk6", Method::RK6 },
+	{ "dopri45", Method::DOPRI45 },
+	{ "verlet", Method::Verlet },
+	{ "yoshida4", Method::Yoshida4 },
+	{ "yoshida6", Method::Yoshida6 },
+	{ "midpoint", Method::Midpoint },
+	{ "beuler", Method::BackwardEuler },
+	{ "sdirk2", Method::SDIRK2 }
+};
+
+static Method ParseMethod(const std::string& name)
+{
+	for (const auto& m : METHODS)
+		if (name == m.name)
+			return m.method;
+
+	throw std::invalid_argument("Unknown method '" + name + "'.");
+}
+
+// Start state from --q1 --q2 --w1 --w2, at rest with both links level by default
+static Vector ParseState(const Options& options)
+{
+	return Vector
+	{
+		options.Number("q1", 0.0),
+		options.Number("q2", 0.0),
+		options.Number("w1", 0.0),
+		options.Number("w2", 0.0)
+	};
+}
+
+static Result Simulate(const Method method, const Vector& x, const double dt, const long long steps)
+{
+	Result result{ Robot(method), steps, 0.0 };
+	result.robot.SetState(x);
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (long long i = 0; i < steps; i++)
+		result.robot.Update(dt);
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+// Far more than any run finishes, and exact in a double
+static constexpr long long MAX_STEPS = 1'000'000'000'000'000;
+// Halvings of the step in a sweep, past which it is below a double's resolution of the start
+static constexpr long long MAX_HALVINGS = 52;
+
+// Steps of dt to cover time, refusing counts a long long cannot hold
+static long long StepCount(const double time, const double dt)
+{
+	const double steps = std::round(time / dt);
+
+	if (!(steps >= 0.0 && steps <= double(MAX_STEPS)))
+		throw std::invalid_argument("The time must take between 0 and " + std::to_string(MAX_STEPS) + " steps of dt.");
+
+	return (long long)steps;
+}
+
+static double StepsPerSecond(const Result& result)
+{
+	return result.seconds > 0.0 ? result.steps / result.seconds : 0.0;
+}
+
+// "run [--method rk4] [--dt h] [--steps n | --time t] [--q1 --q2 --w1 --w2]" steps the
+// double pendulum and prints the final state, the speed and the energy drift
+static void RunHeadless(const Args& args)
+{
+	const Options options(args);
+	const std::string name = options.Text("method", "rk4");
+	const double dt = options.Number("dt", 1.0 / cfg::sim::RATE);
+
+	if (!(dt > 0.0))
+		throw std::invalid_argument("Usage: run [--method rk4] [--dt h] [--steps n | --time t] [--q1 --q2 --w1 --w2]");
+
+	const long long steps = options.Has("steps") ? options.Integer("steps", 0, 0, MAX_STEPS)
+		: StepCount(options.Number("time", 10.0), dt);
+	const Vector x = ParseState(options);
+	options.Finish();
+
+	const Result result = Simulate(ParseMethod(name), x, dt, steps);
+	const State& q = result.robot.GetPositions();
+	const State& w = result.robot.GetVelocities();
+	const Monitor& monitor = result.robot.GetMonitor();
+
+	std::printf("method %s, dt %g s, %lld steps, %g s simulated\n", name.c_str(), dt, steps, result.robot.GetTime());
+	std::printf("state q1 %.12f q2 %.12f w1 %.12f w2 %.12f\n", q[0], q[1], w[0], w[1]);
+	std::printf("energy %.12f J, friction work %.12f J\n", monitor.GetEnergy().total, monitor.GetDissipated());
+	std::printf("drift %.3e J, max %.3e J\n", monitor.GetDrift(), monitor.GetMaxError());
+	std::printf("wall %.3f s, %.4g steps/s\n", result.seconds, StepsPerSecond(result));
+}
+
+// "bench [--dt h] [--time t] [--q1 --q2 --w1 --w2]" runs the same swing with every
+// method, printing speed and energy drift side by side
+static void RunBench(const Args& args)
+{
+	const Options options(args);
+	const double dt = options.Number("dt", 1.0 / cfg::sim::RATE);
+	const double time = options.Number("time", 10.0);
+	const Vector x = ParseState(options);
+	options.Finish();
+
+	if (!(dt > 0.0) || !(time > 0.0))
+		throw std::invalid_argument("Usage: bench [--dt h] [--time t] [--q1 --q2 --w1 --w2]");
+
+	const long long steps = StepCount(time, dt);
+	std::printf("%-10s %12s %12s %12s\n", "method", "steps/s", "drift J", "max J");
+
+	for (const auto& m : METHODS)
+	{
+		const Result result = Simulate(m.method, x, dt, steps);
+		const Monitor& monitor = result.robot.GetMonitor();
+		std::printf("%-10s %12.4g %12.3e %12.3e\n", m.name, StepsPerSecond(result), monitor.GetDrift(), monitor.GetMaxError());
+	}
+}
+
+// "sweep [--method rk4] [--time t] [--from h] [--count n] [--tol e] [--q1 --q2 --w1 --w2]"
+// halves the step from h count times and reports the largest whose energy error stays below e
+static void RunSweep(const Args& args)
+{
+	const Options options(args);
+	const std::string name = options.Text("method", "rk4");
+	const double time = options.Number("time", 10.0);
+	const double from = options.Number("from", 1e-2);
+	const int count = (int)options.Integer("count", 8, 1, MAX_HALVINGS);
+	const double tol = options.Number("tol", 1e-6);
+	const Vector x = ParseState(options);
+	options.Finish();
+
+	if (!(time > 0.0) || !(from > 0.0))
+		throw std::invalid_argument("Usage: sweep [--method rk4] [--time t] [--from h] [--count n] [--tol e] [--q1 --q2 --w1 --w2]");
+
+	const Method method = ParseMethod(name);
+	double best = 0.0;
+	std::printf("%-12s %12s %12s %12s\n", "dt s", "steps/s", "drift J", "max J");
+
+	for (int i = 0; i < count; i++)
+	{
+		const double dt = std::ldexp(from, -i);
+		const Result result = Simulate(method, x, dt, StepCount(time, dt));
+		const Monitor& monitor = result.robot.GetMonitor();
+		std::printf("%-12g %12.4g %12.3e %12.3e\n", dt, StepsPerSecond(result), monitor.GetDrift(), monitor.GetMaxError());
+
+		if (best == 0.0 && monitor.GetMaxError() <= tol)
+			best = dt;
+	}
+
+	if (best > 0.0)
+		std::printf("largest dt within %g J: %g s\n", tol, best);
+	else
+		std::printf("no dt within %g J\n", tol);
+}
+
+// "flip <width> <height> <name> [exact]" writes name.ppm and name.pfm without a window,
+// resuming from name.ckpt when an earlier run was stopped part way. The map is
+// refined as a quadtree unless exact asks for every pixel to be integrated.
+static void RunFlip(const Args& args)
+{
+	int width, height;
+
+	if (args.size() < 3 || args.size() > 4 || !Parse(args[0], width) || !Parse(args[1], height)
+		|| (args.size() == 4 && args[3] != "exact"))
+		throw std::invalid_argument("Usage: flip <width> <height> <name> [exact]");
 
+	const std::string& name = args[2];
+	const std::string mode = args.size() == 4 ? args[3] : "";
+
+	const std::string checkpoint = name + ".ckpt";
+	Pool pool;
+	FlipMap map(width, height, mode == "exact" ? Refine::Exact : Refine::Quadtree);
+
+	map.Load(checkpoint);
+	map.Generate(pool, checkpoint);
+	map.WritePpm(name + ".ppm");
+	map.WritePfm(name + ".pfm");
+
+	std::filesystem::remove(checkpoint);
+}
+
+// "section <e_min> <e_max> <count> <seconds> <name>" starts count pendulums at rest
+// with straight links, energies spread over [e_min, e_max], and records where each
+// passes hanging straight down while swinging anticlockwise. Crossings stream to
+// name.bin as they finish and name.ppm plots q2 against w2.
+static void RunSection(const Args& args)
+{
+	double e_min, e_max, seconds;
+	int count;
+
+	if (args.size() != 5 || !Parse(args[0], e_min) || !Parse(args[1], e_max) || !Parse(args[2], count)
+		|| !Parse(args[3], seconds) || count < 1)
+		throw std::invalid_argument("Usage: section <e_min> <e_max> <count> <seconds> <name>");
+
+	const std::string& name = args[4];
+
+	std::vector<Vector> starts(count);
+
+	for (int i = 0; i < count; i++)
+		starts[i] = Section::AtEnergy(count == 1 ? e_min : e_min + (e_max - e_min) * i / (count - 1));
+
+	constexpr double PI = 3.14159265358979323846;
+	const Section section(Plane{ Vector{ 1.0, 0.0, 0.0, 0.0 }, -PI / 2, +1, true });
+	SectionImage image(1024, 1024, 1, -PI, PI, 3, -30.0, 30.0);
+
+	std::ofstream file(name + ".bin", std::ios::binary | std::ios::trunc);
+	Pool pool;
+
+	section.Run(pool, starts, seconds, [&](const size_t i, const std::vector<Crossing>& crossings)
+	{
+		Section::Write(file, i, crossings);
+		image.Add(crossings);
+	});
+
+	if (!file)
+		throw std::runtime_error("Failed to write '" + name + ".bin'.");
+
+	image.WritePpm(name + ".ppm");
+}
+
+// "lyapunov <width> <height> <seconds> <name>" releases a pendulum from rest at every
+// pair of starting angles, laid out as in the flip map, and integrates its Lyapunov
+// spectrum for seconds. The largest exponent goes to name.pfm and every spectrum to
+// name.bin as four little endian doubles in 1/s per pixel, row by row from the top.
+static void RunLyapunov(const Args& args)
+{
+	int width, height;
+	double seconds;
+
+	if (args.size() != 4 || !Parse(args[0], width) || !Parse(args[1], height) || !Parse(args[2], seconds)
+		|| width < 1 || height < 1 || !(seconds > 0.0))
+		throw std::invalid_argument("Usage: lyapunov <width> <height> <seconds> <name>");
+
+	static_assert(cfg::lyapunov::BATCH % cfg::lyapunov::RENORM == 0, "Batches must end on a Gram-Schmidt pass");
+
+	constexpr double PI = 3.14159265358979323846;
+	const std::string& name = args[3];
+	const long long steps = StepCount(seconds, cfg::lyapunov::STEP);
+
+	Lyapunov lyapunov(size_t(width) * height);
+	Pool pool;
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			// Pixel centres over [-pi, pi], link 1 along x and link 2 up the rows
+			const double a1 = -PI + (x + 0.5) * 2 * PI / width;
+			const double a2 = PI - (y + 0.5) * 2 * PI / height;
+			lyapunov.Set(size_t(y) * width + x, FlipMap::Start(a1, a2));
+		}
+	}
+
+	for (long long done = 0; done < steps; done += cfg::lyapunov::BATCH)
+		lyapunov.Update(cfg::lyapunov::STEP, (int)std::min<long long>(cfg::lyapunov::BATCH, steps - done), pool);
+
+	std::ofstream spectra(name + ".bin", std::ios::binary | std::ios::trunc);
+	std::ofstream largest(name + ".pfm", std::ios::binary | std::ios::trunc);
+
+	for (size_t i = 0; i < lyapunov.GetSize(); i++)
+	{
+		const Lyapunov::Spectrum spectrum = lyapunov.GetSpectrum(i);
+		spectra.write(reinterpret_cast<const char*>(spectrum.data()), sizeof(spectrum));
+	}
+
+	// Negative scale marks little endian, rows run bottom to top
+	largest << "Pf\n" << width << ' ' << height << "\n-1.0\n";
+	std::vector<float> row(width);
+
+	for (int y = height; y-- > 0;)
+	{
+		for (int x = 0; x < width; x++)
+			row[x] = float(lyapunov.GetSpectrum(size_t(y) * width + x)[0]);
+
+		largest.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+	}
+
+	if (!spectra)
+		throw std::runtime_error("Failed to write '" + name + ".bin'.");
+	if (!largest)
+		throw std::runtime_error("Failed to write '" + name + ".pfm'.");
+}
+
+#ifndef PENDULUM_HEADLESS
+// "interactive [--trace file.json]" opens the window, optionally recording a timeline of
+// every frame phase and physics advance for chrome://tracing or ui.perfetto.dev
+static void RunInteractive(const Args& args)
+{
+	const Options options(args);
+	const std::string trace = options.Text("trace", "");
+	options.Finish();
+
+#if PENDULUM_PROFILE
+	Window window;
+	std::unique_ptr<prof::Tracer> tracer;
+
+	if (!trace.empty())
+		tracer = std::make_unique<prof::Tracer>(trace);
+
+	window.Run();
+
+	if (tracer)
+	{
+		tracer->Finish();
+		std::printf("Traced %llu events to '%s', dropped %llu\n",
+			(unsigned long long)tracer->GetWritten(), trace.c_str(), (unsigned long long)tracer->GetDropped());
+	}
+#else
+	if (!trace.empty())
+		throw std::invalid_argument("Tracing needs a build with PENDULUM_PROFILE enabled.");
+
+	Window window;
+	window.Run();
+#endif
+}
+#endif
+
+static void PrintUsage()
+{
+	std::printf(
+		"Usage: DoublePendulum [command] [arguments]\n"
+#ifndef PENDULUM_HEADLESS
+		"  interactive [--trace file]     open the window, the default, optionally tracing frames\n"
+#endif
+		"  run [--method rk4] [--dt h] [--steps n | --time t] [--q1 --q2 --w1 --w2]\n"
+		"  bench [--dt h] [--time t] [--q1 --q2 --w1 --w2]\n"
+		"  sweep [--method rk4] [--time t] [--from h] [--count n] [--tol e] [--q1 --q2 --w1 --w2]\n"
+		"  flip <width> <height> <name> [exact]\n"
+		"  section <e_min> <e_max> <count> <seconds> <name>\n"
+		"  lyapunov <width> <height> <seconds> <name>\n"
+		"Methods: euler rk4 rk38 rk6 dopri45 verlet yoshida4 yoshida6 midpoint beuler sdirk2\n"
+	);
+}
+
+// Commands other than interactive never touch SDL video or TTF
+static int Main(const int argc, char* argv[])
+{
+#ifdef PENDULUM_HEADLESS
+	const std::string command = argc > 1 ? argv[1] : "help";
+#else
+	const std::string command = argc > 1 ? argv[1] : "interactive";
+#endif
+	const Args args(argv + std::min(argc, 2), argv + argc);
+
+	if (command == "interactive")
+	{
+#ifdef PENDULUM_HEADLESS
+		throw std::runtime_error("This is a headless build without the window.");
+#else
+		RunInteractive(args);
+#endif
+	}
+	else if (command == "run")
+		RunHeadless(args);
+	else if (command == "bench")
+		RunBench(args);
+	else if (command == "sweep")
+		RunSweep(args);
+	else if (command == "flip")
+		RunFlip(args);
+	else if (command == "section")
+		RunSection(args);
+	else if (command == "lyapunov")
+		RunLyapunov(args);
+	else if (command == "help" || command == "--help")
+		PrintUsage();
+	else
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	return 0;
+}
+
+#if defined(_WIN32) && !defined(PENDULUM_HEADLESS)
+#define ErrorBox(msg) MessageBoxA(NULL, msg, "Error", MB_ICONERROR | MB_OK)
+
+// The Windows subsystem starts without a console, borrow the caller's for headless output
 int CALLBACK
 WinMain(HINSTANCE hinstance, HINSTANCE prev_hinstance, LPSTR cmdline, int cmdshow)
 {
+	const bool console = __argc > 1 && AttachConsole(ATTACH_PARENT_PROCESS);
+
+	if (console)
+	{
+		std::freopen("CONOUT$", "w", stdout);
+		std::freopen("CONOUT$", "w", stderr);
+	}
+
 #ifdef NDEBUG
 	try
 	{
-		Window window;
-		window.Run();
+		return Main(__argc, __argv);
 	}
 	catch (const std::exception& e)
 	{
-		ErrorBox(e.what());
+		if (console)
+			std::fprintf(stderr, "Error: %s\n", e.what());
+		else
+			ErrorBox(e.what());
 	}
 	catch (...)
 	{
 		ErrorBox("An unknown error has occurred.");
 	}
+
+	return 1;
 #else
-	Window window;
-	window.Run();
+	return Main(__argc, __argv);
 #endif
 }
+#else
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return Main(argc, argv);
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "Error: %s\n", e.what());
+	}
+
+	return 1;
+}
+#endif
@@ -0,0 +1,88 @@
+#include "monitor.hpp"
+#include "dynamics.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+
+Monitor::Monitor()
+	: m_Energy{}, m_Derivative{}, m_Initial{}, m_Dissipated{}, m_MaxError{}, m_Time{}
+{
+}
+
+void Monitor::Reset(const Vector& x)
+{
+	m_Energy = Measure(x, m_Derivative);
+	m_Initial = m_Energy.total;
+	m_Dissipated = 0.0;
+	m_MaxError = 0.0;
+	m_Time = 0.0;
+}
+
+void Monitor::Update(const Vector& x, const double dt)
+{
+	const Vector& d0 = m_Derivative;
+	Vector d1;
+	m_Energy = Measure(x, d1);
+
+	// Power lost P = u1 w1^2 + u2 w2^2 and its rate dP/dt = 2 (u1 w1 a1 + u2 w2 a2)
+	using namespace dynamics;
+	const double p0 = Dissipation(d0[0], d0[1]);
+	const double p1 = Dissipation(d1[0], d1[1]);
+	const double dp0 = 2.0 * (u1 * d0[0] * d0[2] + u2 * d0[1] * d0[3]);
+	const double dp1 = 2.0 * (u1 * d1[0] * d1[2] + u2 * d1[1] * d1[3]);
+
+	m_Dissipated += 0.5 * dt * (p0 + p1) + dt * dt / 12.0 * (dp0 - dp1);
+	m_Derivative = d1;
+	m_Time += dt;
+	m_MaxError = std::max(m_MaxError, std::fabs(GetDrift()));
+}
+
+Energy Monitor::Measure(const Vector& x, Vector& dx)
+{
+	const auto trig = dynamics::Angles(x[0], x[1]);
+	Energy e;
+
+	dynamics::Accelerations(trig, x[2], x[3], dx[2], dx[3]);
+	dynamics::Energy(trig, x[2], x[3], e.kinetic, e.potential);
+	dx[0] = x[2];
+	dx[1] = x[3];
+	e.total = e.kinetic + e.potential;
+
+	return e;
+}
+
+const Energy& Monitor::GetEnergy() const
+{
+	return m_Energy;
+}
+
+const Vector& Monitor::GetDerivative() const
+{
+	return m_Derivative;
+}
+
+double Monitor::GetInitial() const
+{
+	return m_Initial;
+}
+
+double Monitor::GetDissipated() const
+{
+	return m_Dissipated;
+}
+
+double Monitor::GetDrift() const
+{
+	return m_Energy.total + m_Dissipated - m_Initial;
+}
+
+double Monitor::GetMaxError() const
+{
+	return m_MaxError;
+}
+
+double Monitor::GetDriftRate() const
+{
+	return m_Time > 0.0 ? GetDrift() / m_Time : 0.0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "integrator.hpp"
+
+
+// Energy of one double pendulum in joules
+struct Energy
+{
+	double kinetic;
+	double potential;
+	double total;
+};
+
+// Incremental energy bookkeeping against the exact power balance
+// dE/dt = -(u1 w1^2 + u2 w2^2). The friction work is integrated over each step
+// by the trapezoid rule with its Hermite end correction, fourth order like RK4,
+// so what remains of E + W - E0 is the integrator's own error. Nothing is
+// stored per step, the monitor can stay on for runs of any length.
+class Monitor
+{
+public:
+	Monitor();
+
+	// Start over from x
+	void Reset(const Vector& x);
+	// Account for a step of dt ending at x
+	void Update(const Vector& x, const double dt);
+
+	// Energy of x and its derivative dx, sharing one set of trig terms
+	static Energy Measure(const Vector& x, Vector& dx);
+
+	const Energy& GetEnergy() const;
+	// Derivative at the last state, { w1, w2, a1, a2 }
+	const Vector& GetDerivative() const;
+	double GetInitial() const;
+	// Work done by friction so far, positive while it drains energy
+	double GetDissipated() const;
+	// E + W - E0, zero for the exact solution
+	double GetDrift() const;
+	// Largest |drift| seen
+	double GetMaxError() const;
+	// Mean drift per second, a step size gauge
+	double GetDriftRate() const;
+
+private:
+	Energy m_Energy;
+	Vector m_Derivative;
+	double m_Initial;
+	double m_Dissipated;
+	double m_MaxError;
+	double m_Time;
+};
@@ -0,0 +1,90 @@
+#include "pacer.hpp"
+
+#include <cmath>
+#include <thread>
+
+using nano = std::chrono::nanoseconds;
+
+
+Pacer::Pacer(const double rate, const double spin)
+	: m_Period{ std::chrono::duration_cast<Clock::duration>(nano{ (long long)(1e9 / rate) }) },
+	m_Spin{ std::chrono::duration_cast<Clock::duration>(nano{ (long long)(spin * 1e9) }) },
+	m_Deadline{ Clock::now() }, m_Mark{ Clock::now() }, m_Interval{}, m_Jitter{}, m_MaxJitter{}
+{
+}
+
+void Pacer::Wait()
+{
+	m_Deadline += m_Period;
+	Clock::time_point now = Clock::now();
+
+	// Fell more than a period behind, so start afresh instead of bursting
+	if (now > m_Deadline + m_Period)
+	{
+		m_Deadline = now;
+		return;
+	}
+
+	// Track how late the scheduler wakes us relative to the sleep target
+	if (m_Deadline - now > m_Spin)
+	{
+		const Clock::time_point target = m_Deadline - m_Spin;
+		std::this_thread::sleep_until(target);
+		now = Clock::now();
+
+		const double late = std::chrono::duration_cast<nano>(now - target).count() / 1e9;
+		m_Jitter += 0.05 * (late - m_Jitter);
+
+		if (late > m_MaxJitter)
+			m_MaxJitter = late;
+	}
+
+	while (now < m_Deadline)
+	{
+		std::this_thread::yield();
+		now = Clock::now();
+	}
+}
+
+void Pacer::Mark(const bool measure)
+{
+	const Clock::time_point now = Clock::now();
+	const double interval = std::chrono::duration_cast<nano>(now - m_Mark).count() / 1e9;
+	m_Mark = now;
+
+	if (!measure)
+		return;
+
+	// The first interval seeds the average rather than counting as jitter
+	if (m_Interval == 0.0)
+	{
+		m_Interval = interval;
+		return;
+	}
+
+	const double late = std::abs(interval - m_Interval);
+	m_Interval += 0.05 * (interval - m_Interval);
+	m_Jitter += 0.05 * (late - m_Jitter);
+
+	if (late > m_MaxJitter)
+		m_MaxJitter = late;
+}
+
+void Pacer::Reset()
+{
+	m_Deadline = Clock::now();
+	m_Mark = m_Deadline;
+	m_Interval = 0.0;
+	m_Jitter = 0.0;
+	m_MaxJitter = 0.0;
+}
+
+double Pacer::GetJitter() const
+{
+	return m_Jitter;
+}
+
+double Pacer::GetMaxJitter() const
+{
+	return m_MaxJitter;
+}
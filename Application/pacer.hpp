@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+
+
+// Deadline based loop pacing: sleep most of the way, spin the tail
+class Pacer
+{
+public:
+	Pacer(const double rate, const double spin);
+
+	void Wait();
+	// For loops paced elsewhere, e.g. by vsync: measure how far the time since the last
+	// mark strays from the average interval, or only restart the interval when not measure
+	void Mark(const bool measure = true);
+	void Reset();
+
+	double GetJitter() const;
+	double GetMaxJitter() const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::duration m_Period;
+	Clock::duration m_Spin;
+	Clock::time_point m_Deadline;
+	Clock::time_point m_Mark;
+	double m_Interval;
+	double m_Jitter;
+	double m_MaxJitter;
+};
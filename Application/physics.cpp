@@ -0,0 +1,249 @@
+#include "physics.hpp"
+#include "profile.hpp"
+
+#include <iterator>
+#include <algorithm>
+
+using nano = std::chrono::nanoseconds;
+using Time = std::chrono::steady_clock::time_point;
+
+
+Physics::Physics()
+	: m_Robot{}, m_Chain{ MakeChain<params::Config::SIZE>() }, m_Stepper{}, m_Pacer{ cfg::sim::LOOP_RATE, 0.0 },
+	m_Time{}, m_Steps{}, m_OneStep{ false }, m_Pause{ false }, m_UseChain{ false },
+	m_Links{}, m_Joints{}, m_Running{ false }, m_Pending{ false }
+{
+}
+
+Physics::~Physics()
+{
+	Stop();
+}
+
+void Physics::Start()
+{
+	if (m_Running.exchange(true))
+		return;
+
+	m_Thread = std::thread(&Physics::Loop, this);
+}
+
+void Physics::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_Running.store(false);
+	}
+
+	m_Wake.notify_one();
+
+	if (m_Thread.joinable())
+		m_Thread.join();
+}
+
+bool Physics::Send(const Command command)
+{
+	if (!m_Commands.Push(command))
+		return false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_Pending.store(true);
+	}
+
+	m_Wake.notify_one();
+	return true;
+}
+
+bool Physics::Launch(const Vector& x)
+{
+	if (!m_Launches.Push(x))
+		return false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_WakeMutex);
+		m_Pending.store(true);
+	}
+
+	m_Wake.notify_one();
+	return true;
+}
+
+bool Physics::Update()
+{
+	return m_Snapshots.Update();
+}
+
+const Snapshot& Physics::GetSnapshot() const
+{
+	return m_Snapshots.Front();
+}
+
+void Physics::Loop()
+{
+	Time time = std::chrono::steady_clock::now();
+	m_Pacer.Reset();
+	PROFILE_THREAD("physics");
+
+	while (m_Running.load(std::memory_order_relaxed))
+	{
+		bool changed = HandleCommands();
+
+		Time now = std::chrono::steady_clock::now();
+		auto since = std::chrono::duration_cast<nano>(now - time);
+		double dt = since.count() / 1e9;
+
+		time = now;
+
+		if (m_OneStep || !m_Pause)
+		{
+			const uint64_t steps = m_Steps;
+
+			if (m_UseChain)
+				Advance(m_Chain, dt);
+			else
+				Advance(m_Robot, dt);
+
+			changed = changed || m_Steps != steps;
+		}
+
+		// Nothing to publish while paused, letting the renderer idle
+		if (changed)
+			Publish(dt);
+
+		if (m_Pause && !m_OneStep)
+		{
+			// Sleep until told otherwise, without counting the pause as a step's worth of time
+			Idle();
+			time = std::chrono::steady_clock::now();
+		}
+		else
+			m_Pacer.Wait();
+	}
+}
+
+void Physics::Idle()
+{
+	std::unique_lock<std::mutex> lock(m_WakeMutex);
+	m_Wake.wait(lock, [this] { return m_Pending.load() || !m_Running.load(); });
+	m_Pending.store(false);
+}
+
+template <class Model>
+void Physics::Advance(Model& model, const double dt)
+{
+	PROFILE_SCOPE(prof::Phase::Physics);
+
+	if (m_OneStep)
+	{
+		m_Stepper.Step(model);
+		m_Time += m_Stepper.GetStepSize();
+		m_Steps++;
+		m_OneStep = false;
+		m_Pause = true;
+	}
+	else
+	{
+		const int steps = m_Stepper.Advance(model, dt);
+		m_Time += steps * m_Stepper.GetStepSize();
+		m_Steps += steps;
+	}
+}
+
+bool Physics::HandleCommands()
+{
+	bool handled = false;
+	Command command;
+	Vector x;
+
+	while (m_Launches.Pop(x))
+	{
+		handled = true;
+		m_Robot.SetState(x);
+		m_Stepper.Reset();
+		m_Time = 0.0;
+		m_UseChain = false;
+		m_Pause = false;
+	}
+
+	while (m_Commands.Pop(command))
+	{
+		handled = true;
+
+		switch (command)
+		{
+		case Command::Pause:
+			m_Pause = !m_Pause;
+			break;
+		case Command::Step:
+			m_OneStep = true;
+			break;
+		case Command::Restart:
+			m_Robot.Restart();
+			m_Chain.Restart();
+			m_Stepper.Reset();
+			m_Time = 0.0;
+			break;
+		case Command::Model:
+			m_UseChain = !m_UseChain;
+			m_Stepper.Reset();
+			break;
+		}
+	}
+
+	return handled;
+}
+
+void Physics::Publish(const double dt)
+{
+	Snapshot& snapshot = m_Snapshots.Back();
+
+	snapshot.robot = m_Robot;
+	snapshot.segments.clear();
+
+	if (m_UseChain)
+	{
+		m_Chain.GetLinkFrames(m_Links);
+		m_Chain.GetJointFrames(m_Joints);
+
+		constexpr size_t last = std::size(cfg::chain::WIDTH) - 1;
+		const auto& q = m_Chain.GetPositions();
+		double angle = 0.0;
+
+		for (size_t i = 0; i < m_Chain.GetSize(); i++)
+		{
+			const size_t k = std::min(i, last);
+			angle += q[i];
+			snapshot.segments.push_back(Segment{
+				m_Links[i], m_Joints[i], angle, m_Chain.GetLength(i),
+				cfg::chain::WIDTH[k], cfg::chain::RADIUS[k]
+			});
+		}
+	}
+	else
+	{
+		const Frame links = m_Robot.GetLinkFrames();
+		const Frame joints = m_Robot.GetJointFrames();
+		const State& q = m_Robot.GetPositions();
+		double angle = 0.0;
+
+		for (size_t i = 0; i < 2; i++)
+		{
+			angle += q[i];
+			snapshot.segments.push_back(Segment{
+				links[i], joints[i], angle, cfg::link::LENGTH[i],
+				cfg::link::WIDTH[i], cfg::joint::RADIUS[i]
+			});
+		}
+	}
+	snapshot.time = m_Time;
+	snapshot.delta = dt;
+	snapshot.ratio = m_Stepper.GetRatio();
+	snapshot.jitter = m_Pacer.GetJitter();
+	snapshot.max_jitter = m_Pacer.GetMaxJitter();
+	snapshot.steps = m_Steps;
+	snapshot.paused = m_Pause;
+	snapshot.chain = m_UseChain;
+
+	m_Snapshots.Publish();
+}
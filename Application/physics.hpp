@@ -0,0 +1,100 @@
+#pragma once
+
+#include "queue.hpp"
+#include "fixed.hpp"
+#include "robot.hpp"
+#include "buffer.hpp"
+#include "config.hpp"
+#include "pacer.hpp"
+#include "stepper.hpp"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+
+
+enum class Command
+{
+	Pause,
+	Step,
+	Restart,
+	Model
+};
+
+// Geometry of one link for rendering
+struct Segment
+{
+	Coord centre;
+	Coord joint;
+	double angle;
+	double length;
+	double width;
+	double radius;
+};
+
+// State published by the physics thread for rendering
+struct Snapshot
+{
+	Robot robot;
+	std::vector<Segment> segments;
+	double time;
+	double delta;
+	double ratio;
+	// Wake-up lateness of the physics loop in seconds
+	double jitter;
+	double max_jitter;
+	uint64_t steps;
+	bool paused;
+	bool chain;
+};
+
+// Steps the robot or chain on its own thread
+class Physics
+{
+public:
+	Physics();
+	~Physics();
+
+	void Start();
+	void Stop();
+	bool Send(const Command command);
+	// Restart the double pendulum from x = { q1, q2, w1, w2 } and run it
+	bool Launch(const Vector& x);
+	bool Update();
+	const Snapshot& GetSnapshot() const;
+
+private:
+	void Loop();
+	// Block until a command or launch arrives or the loop is stopped
+	void Idle();
+	bool HandleCommands();
+	void Publish(const double dt);
+
+	template <class Model>
+	void Advance(Model& model, const double dt);
+
+	Robot m_Robot;
+	ChainFor<params::Config::SIZE> m_Chain;
+	Stepper m_Stepper;
+	Pacer m_Pacer;
+	double m_Time;
+	uint64_t m_Steps;
+	bool m_OneStep;
+	bool m_Pause;
+	bool m_UseChain;
+	std::vector<Coord> m_Links;
+	std::vector<Coord> m_Joints;
+
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+	std::atomic<bool> m_Pending;
+	std::mutex m_WakeMutex;
+	std::condition_variable m_Wake;
+	SpscQueue<Command, 64> m_Commands;
+	SpscQueue<Vector, 8> m_Launches;
+	TripleBuffer<Snapshot> m_Snapshots;
+};
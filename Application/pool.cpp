@@ -0,0 +1,241 @@
+#include "pool.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+	constexpr uint64_t Pack(const uint64_t begin, const uint64_t end)
+	{
+		return begin | end << 32;
+	}
+
+	constexpr uint32_t Begin(const uint64_t range)
+	{
+		return uint32_t(range);
+	}
+
+	constexpr uint32_t End(const uint64_t range)
+	{
+		return uint32_t(range >> 32);
+	}
+}
+
+Pool::Pool(const size_t threads, const bool pin)
+	: m_Workers{}, m_Threads{}, m_Size{ threads }, m_Pin{ pin },
+	m_Task{ nullptr }, m_Body{ nullptr }, m_Pending{ 0 }, m_Done{ 0 }, m_Wall{},
+	m_Generation{ 0 }, m_Stop{ false }
+{
+	if (m_Size == 0)
+		m_Size = std::max(1u, std::thread::hardware_concurrency());
+
+	m_Workers.reset(new Worker[m_Size]);
+
+	for (size_t i = 0; i < m_Size; i++)
+		m_Workers[i].range.store(0, std::memory_order_relaxed);
+
+	ResetStats();
+
+	// Only the threads made here are pinned, the caller's affinity is its own
+	for (size_t i = 1; i < m_Size; i++)
+		m_Threads.emplace_back(&Pool::Loop, this, i);
+}
+
+Pool::~Pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+
+	m_Wake.notify_all();
+
+	for (std::thread& thread : m_Threads)
+		thread.join();
+}
+
+void Pool::Run(const size_t count, const Task task, void* body)
+{
+	if (count == 0)
+		return;
+	if (count > UINT32_MAX)
+		throw std::length_error("Pool::For supports at most 2^32 - 1 items.");
+
+	const Clock::time_point start = Clock::now();
+
+	// Publish the task before the ranges so whoever takes an item sees it
+	m_Task.store(task, std::memory_order_relaxed);
+	m_Body.store(body, std::memory_order_relaxed);
+	m_Pending.store(count, std::memory_order_relaxed);
+	m_Done.store(0, std::memory_order_relaxed);
+
+	for (size_t i = 0; i < m_Size; i++)
+		m_Workers[i].range.store(Pack(count * i / m_Size, count * (i + 1) / m_Size), std::memory_order_release);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Generation++;
+	}
+
+	m_Wake.notify_all();
+	Work(0);
+
+	// Every worker checks out before the ranges can be reused by the next call
+	while (m_Done.load(std::memory_order_acquire) < m_Size - 1)
+		std::this_thread::yield();
+
+	m_Wall += std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void Pool::Loop(const size_t index)
+{
+	if (m_Pin)
+		Pin(index);
+
+	uint64_t seen = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Wake.wait(lock, [&] { return m_Stop || m_Generation != seen; });
+
+			if (m_Stop)
+				return;
+
+			seen = m_Generation;
+		}
+
+		Work(index);
+		m_Done.fetch_add(1, std::memory_order_release);
+	}
+}
+
+void Pool::Work(const size_t index)
+{
+	Worker& self = m_Workers[index];
+	uint32_t item;
+
+	// Keep looking until every item has finished, items in flight may still be split
+	while (m_Pending.load(std::memory_order_acquire) > 0)
+	{
+		if (Pop(self, item) || Steal(index, item))
+			Execute(self, item);
+		else
+			std::this_thread::yield();
+	}
+}
+
+bool Pool::Pop(Worker& worker, uint32_t& item)
+{
+	uint64_t range = worker.range.load(std::memory_order_acquire);
+
+	while (Begin(range) < End(range))
+	{
+		if (worker.range.compare_exchange_weak(range, Pack(Begin(range) + 1, End(range)), std::memory_order_acq_rel))
+		{
+			item = Begin(range);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool Pool::Steal(const size_t index, uint32_t& item)
+{
+	for (size_t k = 1; k < m_Size; k++)
+	{
+		Worker& victim = m_Workers[(index + k) % m_Size];
+		uint64_t range = victim.range.load(std::memory_order_acquire);
+
+		while (Begin(range) < End(range))
+		{
+			// Take the back half, the victim keeps working from the front
+			const uint32_t begin = Begin(range);
+			const uint32_t end = End(range);
+			const uint32_t mid = end - (end - begin + 1) / 2;
+
+			if (victim.range.compare_exchange_weak(range, Pack(begin, mid), std::memory_order_acq_rel))
+			{
+				Worker& self = m_Workers[index];
+				self.range.store(Pack(mid + 1, end), std::memory_order_release);
+				self.stats.steals++;
+				item = mid;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void Pool::Execute(Worker& worker, const uint32_t item)
+{
+	const Clock::time_point start = Clock::now();
+	m_Task.load(std::memory_order_relaxed)(m_Body.load(std::memory_order_relaxed), item);
+
+	worker.stats.busy += std::chrono::duration<double>(Clock::now() - start).count();
+	worker.stats.items++;
+
+	// Release so the caller sees the work and the stats once the count hits zero
+	m_Pending.fetch_sub(1, std::memory_order_release);
+}
+
+void Pool::Pin(const size_t index)
+{
+#ifdef _WIN32
+	// Walk the processor groups, machines past 64 logical processors have several
+	DWORD n = DWORD(index);
+	WORD group = 0;
+
+	while (group < GetActiveProcessorGroupCount() && n >= GetActiveProcessorCount(group))
+		n -= GetActiveProcessorCount(group++);
+
+	if (group == GetActiveProcessorGroupCount())
+		return;
+
+	GROUP_AFFINITY affinity{};
+	affinity.Group = group;
+	affinity.Mask = KAFFINITY(1) << n;
+	SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+#else
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(int(index % CPU_SETSIZE), &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+size_t Pool::GetSize() const
+{
+	return m_Size;
+}
+
+Pool::Stats Pool::GetStats(const size_t worker) const
+{
+	return m_Workers[worker].stats;
+}
+
+double Pool::GetUtilisation(const size_t worker) const
+{
+	return m_Wall > 0.0 ? m_Workers[worker].stats.busy / m_Wall : 0.0;
+}
+
+void Pool::ResetStats()
+{
+	for (size_t i = 0; i < m_Size; i++)
+		m_Workers[i].stats = Stats{};
+
+	m_Wall = 0.0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+// Work-stealing thread pool for data parallel loops. Each For call splits its
+// items evenly over the workers, a worker pops from the front of its own range
+// and, once empty, steals the back half of another's. The calling thread works
+// as worker 0, so a pool of one runs everything inline.
+class Pool
+{
+public:
+	// Per worker totals since the last ResetStats
+	struct Stats
+	{
+		double busy;
+		uint64_t items;
+		uint64_t steals;
+	};
+
+	Pool(const size_t threads = 0, const bool pin = cfg::pool::PIN);
+	~Pool();
+
+	Pool(const Pool&) = delete;
+	Pool& operator=(const Pool&) = delete;
+
+	// Call f(i) for every i in [0, count) and return once all have finished
+	template <class F>
+	void For(const size_t count, F&& f)
+	{
+		using Body = std::remove_reference_t<F>;
+		Run(count, [](void* body, const size_t i) { (*static_cast<Body*>(body))(i); }, &f);
+	}
+
+	size_t GetSize() const;
+	Stats GetStats(const size_t worker) const;
+	// Busy time over wall time spent inside For, per worker
+	double GetUtilisation(const size_t worker) const;
+	void ResetStats();
+
+private:
+	using Clock = std::chrono::steady_clock;
+	using Task = void (*)(void*, size_t);
+
+	// One cache line per worker so owners and thieves never false share
+	struct alignas(64) Worker
+	{
+		// Remaining items packed as begin in the low and end in the high 32 bits
+		std::atomic<uint64_t> range;
+		Stats stats;
+	};
+
+	void Run(const size_t count, const Task task, void* body);
+	void Loop(const size_t index);
+	void Work(const size_t index);
+	bool Pop(Worker& worker, uint32_t& item);
+	bool Steal(const size_t index, uint32_t& item);
+	void Execute(Worker& worker, const uint32_t item);
+	void Pin(const size_t index);
+
+	std::unique_ptr<Worker[]> m_Workers;
+	std::vector<std::thread> m_Threads;
+	size_t m_Size;
+	bool m_Pin;
+
+	std::atomic<Task> m_Task;
+	std::atomic<void*> m_Body;
+	std::atomic<size_t> m_Pending;
+	std::atomic<size_t> m_Done;
+	double m_Wall;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	uint64_t m_Generation;
+	bool m_Stop;
+};
@@ -0,0 +1,310 @@
+#include "profile.hpp"
+
+#include <cstdio>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdexcept>
+
+
+// Nothing to build when every probe is compiled out
+#if PENDULUM_PROFILE
+namespace prof
+{
+	namespace
+	{
+		constexpr size_t PHASES = (size_t)Phase::Count;
+
+		// A scope as queued for the trace, begin in nanoseconds of the steady clock
+		struct Event
+		{
+			int64_t begin;
+			uint32_t duration;
+			Phase phase;
+		};
+
+		// One thread's samples, single writer and any number of readers, and
+		// its trace queue, single writer and the tracer's thread reading
+		struct Ring
+		{
+			std::atomic<uint32_t> samples[PHASES][cfg::prof::CAPACITY];
+			std::atomic<uint64_t> heads[PHASES];
+			Event events[cfg::prof::TRACE_CAPACITY];
+			std::atomic<uint64_t> queued;
+			std::atomic<uint64_t> flushed;
+			std::atomic<uint64_t> dropped;
+			// Set under the registry lock
+			std::string name;
+			size_t id;
+
+			Ring(const size_t index)
+				: events{}, queued{ 0 }, flushed{ 0 }, dropped{ 0 }, name{ "thread " + std::to_string(index) }, id{ index }
+			{
+				for (size_t p = 0; p < PHASES; p++)
+				{
+					heads[p].store(0, std::memory_order_relaxed);
+
+					for (std::atomic<uint32_t>& s : samples[p])
+						s.store(0, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		// Rings are never freed, so a reader may still walk one whose thread has exited
+		struct Registry
+		{
+			std::mutex mutex;
+			std::vector<std::unique_ptr<Ring>> rings;
+		};
+
+		// At most one tracer, checked by every scope
+		std::atomic<bool> g_Tracing{ false };
+
+		Registry& GetRegistry()
+		{
+			static Registry registry;
+			return registry;
+		}
+
+		// Only a thread's first sample takes the lock
+		Ring& GetRing()
+		{
+			thread_local Ring* ring = nullptr;
+
+			if (ring == nullptr)
+			{
+				Registry& registry = GetRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+				registry.rings.push_back(std::make_unique<Ring>(registry.rings.size()));
+				ring = registry.rings.back().get();
+			}
+
+			return *ring;
+		}
+
+		std::vector<Ring*> GetRings()
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			std::vector<Ring*> rings;
+
+			for (const auto& ring : registry.rings)
+				rings.push_back(ring.get());
+
+			return rings;
+		}
+
+		int64_t Nanoseconds(const Clock::duration duration)
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+		}
+
+		uint32_t Saturate(const int64_t nanoseconds)
+		{
+			return (uint32_t)std::clamp<int64_t>(nanoseconds, 0, UINT32_MAX);
+		}
+
+		double Percentile(std::vector<uint32_t>& values, const double fraction)
+		{
+			const size_t k = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+			std::nth_element(values.begin(), values.begin() + k, values.end());
+			return values[k] * 1e-6;
+		}
+	}
+
+	void Record(const Phase phase, const Clock::time_point begin, const Clock::time_point end)
+	{
+		Ring& ring = GetRing();
+		const size_t p = (size_t)phase;
+		const uint64_t head = ring.heads[p].load(std::memory_order_relaxed);
+		// Saturate rather than wrap, anything past four seconds is a stall either way
+		const uint32_t duration = Saturate(Nanoseconds(end - begin));
+
+		ring.samples[p][head % cfg::prof::CAPACITY].store(duration, std::memory_order_relaxed);
+		ring.heads[p].store(head + 1, std::memory_order_release);
+
+		if (!g_Tracing.load(std::memory_order_relaxed))
+			return;
+
+		const uint64_t queued = ring.queued.load(std::memory_order_relaxed);
+
+		// Never wait on the tracer, a full queue loses the event instead
+		if (queued - ring.flushed.load(std::memory_order_acquire) >= cfg::prof::TRACE_CAPACITY)
+		{
+			ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+
+		ring.events[queued % cfg::prof::TRACE_CAPACITY] = Event{ Nanoseconds(begin.time_since_epoch()), duration, phase };
+		ring.queued.store(queued + 1, std::memory_order_release);
+	}
+
+	Stats Summarise(const Phase phase)
+	{
+		const size_t p = (size_t)phase;
+		std::vector<uint32_t> values;
+
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			for (const auto& ring : registry.rings)
+			{
+				const uint64_t head = ring->heads[p].load(std::memory_order_acquire);
+				const uint64_t count = std::min<uint64_t>(head, cfg::prof::CAPACITY);
+
+				for (uint64_t i = head - count; i < head; i++)
+					values.push_back(ring->samples[p][i % cfg::prof::CAPACITY].load(std::memory_order_relaxed));
+			}
+		}
+
+		if (values.empty())
+			return Stats{};
+
+		Stats stats;
+		stats.count = values.size();
+		stats.max = *std::max_element(values.begin(), values.end()) * 1e-6;
+		stats.p99 = Percentile(values, 0.99);
+		stats.p95 = Percentile(values, 0.95);
+		stats.p50 = Percentile(values, 0.50);
+		return stats;
+	}
+
+	const char* GetName(const Phase phase)
+	{
+		switch (phase)
+		{
+		case Phase::Frame:
+			return "Frame";
+		case Phase::UpdateInternals:
+			return "UpdateInternals";
+		case Phase::UpdateRobot:
+			return "UpdateRobot";
+		case Phase::RenderBackground:
+			return "RenderBackground";
+		case Phase::RenderLinks:
+			return "RenderLinks";
+		case Phase::RenderJoints:
+			return "RenderJoints";
+		case Phase::RenderMap:
+			return "RenderMap";
+		case Phase::RenderInfo:
+			return "RenderInfo";
+		case Phase::DrawText:
+			return "DrawText";
+		case Phase::HandleEvents:
+			return "HandleEvents";
+		case Phase::Present:
+			return "Present";
+		case Phase::Physics:
+			return "Physics";
+		default:
+			return "";
+		}
+	}
+
+	void SetThreadName(const char* name)
+	{
+		Ring& ring = GetRing();
+		std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+		ring.name = name;
+	}
+
+	Tracer::Tracer(const std::string& path)
+		: m_File{ path, std::ios::trunc }, m_Path{ path }, m_Origin{ Clock::now() }, m_Written{ 0 }, m_Running{ true }, m_Thread{}
+	{
+		if (!m_File)
+			throw std::runtime_error("Failed to open '" + path + "'.");
+
+		if (g_Tracing.exchange(true))
+			throw std::logic_error("Only one trace may be recorded at a time.");
+
+		// Start from empty queues, whatever was left by an earlier trace
+		for (Ring* ring : GetRings())
+			ring->flushed.store(ring->queued.load(std::memory_order_acquire), std::memory_order_release);
+
+		m_File << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		m_Thread = std::thread(&Tracer::Loop, this);
+	}
+
+	Tracer::~Tracer()
+	{
+		Finish();
+	}
+
+	void Tracer::Finish()
+	{
+		if (!m_Thread.joinable())
+			return;
+
+		m_Running.store(false);
+		m_Thread.join();
+		g_Tracing.store(false);
+		Flush();
+
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		// Thread names last, once every thread that recorded is known
+		for (size_t i = 0; i < registry.rings.size(); i++)
+			m_File << (m_Written + i == 0 ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+				<< registry.rings[i]->id << ",\"args\":{\"name\":\"" << registry.rings[i]->name << "\"}}";
+
+		m_File << "\n]}\n";
+		m_File.close();
+	}
+
+	uint64_t Tracer::GetWritten() const
+	{
+		return m_Written;
+	}
+
+	uint64_t Tracer::GetDropped() const
+	{
+		uint64_t dropped = 0;
+
+		for (const Ring* ring : GetRings())
+			dropped += ring->dropped.load(std::memory_order_relaxed);
+
+		return dropped;
+	}
+
+	void Tracer::Loop()
+	{
+		const auto period = std::chrono::duration<double>(cfg::prof::FLUSH_TIME);
+
+		while (m_Running.load(std::memory_order_relaxed))
+		{
+			std::this_thread::sleep_for(period);
+			Flush();
+		}
+	}
+
+	// Timestamps in microseconds from the start of the trace
+	void Tracer::Flush()
+	{
+		const int64_t origin = Nanoseconds(m_Origin.time_since_epoch());
+		char line[160];
+
+		for (Ring* ring : GetRings())
+		{
+			const uint64_t queued = ring->queued.load(std::memory_order_acquire);
+			const uint64_t flushed = ring->flushed.load(std::memory_order_relaxed);
+
+			for (uint64_t i = flushed; i < queued; i++)
+			{
+				const Event& e = ring->events[i % cfg::prof::TRACE_CAPACITY];
+				std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%zu}",
+					m_Written == 0 ? "" : ",\n", GetName(e.phase), (e.begin - origin) * 1e-3, e.duration * 1e-3, ring->id);
+				m_File << line;
+				m_Written++;
+			}
+
+			ring->flushed.store(queued, std::memory_order_release);
+		}
+
+		m_File.flush();
+	}
+}
+#endif
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <fstream>
+
+
+// Build with PENDULUM_PROFILE=0 to compile every probe out
+#ifndef PENDULUM_PROFILE
+#define PENDULUM_PROFILE 1
+#endif
+
+#if PENDULUM_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+// Time the rest of the enclosing scope as one sample of phase, named per line so scopes nest
+#define PROFILE_SCOPE(phase) prof::Scope PROFILE_CONCAT(prof_scope_, __LINE__)(phase)
+// Label the calling thread in traces
+#define PROFILE_THREAD(name) prof::SetThreadName(name)
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
+
+// Scoped timers over the frame phases. Each thread records into its own ring
+// of the last cfg::prof::CAPACITY samples per phase, written with relaxed
+// atomics and never locked, and any thread may summarise them at any time.
+// While a Tracer is alive every scope is also queued as a timeline event.
+namespace prof
+{
+	using Clock = std::chrono::steady_clock;
+
+	enum class Phase
+	{
+		Frame,
+		UpdateInternals,
+		UpdateRobot,
+		RenderBackground,
+		RenderLinks,
+		RenderJoints,
+		RenderMap,
+		RenderInfo,
+		DrawText,
+		HandleEvents,
+		Present,
+		Physics,
+		Count
+	};
+
+	// Percentiles and maximum over the recorded samples in milliseconds
+	struct Stats
+	{
+		uint64_t count;
+		double p50;
+		double p95;
+		double p99;
+		double max;
+	};
+
+	void Record(const Phase phase, const Clock::time_point begin, const Clock::time_point end);
+	// Across every thread's ring
+	Stats Summarise(const Phase phase);
+	const char* GetName(const Phase phase);
+	void SetThreadName(const char* name);
+
+	class Scope
+	{
+	public:
+		explicit Scope(const Phase phase)
+			: m_Phase{ phase }, m_Start{ Clock::now() }
+		{
+		}
+
+		~Scope()
+		{
+			Record(m_Phase, m_Start, Clock::now());
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Phase m_Phase;
+		Clock::time_point m_Start;
+	};
+
+	// Writes every scope as a Chrome trace event (chrome://tracing or Perfetto)
+	// until destroyed. Scopes only copy into their thread's queue of
+	// cfg::prof::TRACE_CAPACITY events, dropping them when it is full, and a
+	// background thread drains the queues to the file every FLUSH_TIME.
+	class Tracer
+	{
+	public:
+		explicit Tracer(const std::string& path);
+		~Tracer();
+
+		Tracer(const Tracer&) = delete;
+		Tracer& operator=(const Tracer&) = delete;
+
+		// Drain the last events and close the file, also done on destruction
+		void Finish();
+		uint64_t GetWritten() const;
+		uint64_t GetDropped() const;
+
+	private:
+		void Loop();
+		void Flush();
+
+		std::ofstream m_File;
+		std::string m_Path;
+		Clock::time_point m_Origin;
+		uint64_t m_Written;
+		std::atomic<bool> m_Running;
+		std::thread m_Thread;
+	};
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+
+// Lock-free bounded single producer, single consumer queue
+template <class T, size_t N>
+class SpscQueue
+{
+	static_assert((N & (N - 1)) == 0, "Queue capacity must be a power of two.");
+
+public:
+	SpscQueue() : m_Items{}, m_Head{ 0 }, m_Tail{ 0 }
+	{
+	}
+
+	// Producer side
+	bool Push(const T& item)
+	{
+		const size_t tail = m_Tail.load(std::memory_order_relaxed);
+
+		if (tail - m_Head.load(std::memory_order_acquire) == N)
+			return false;
+
+		m_Items[tail & (N - 1)] = item;
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side
+	bool Pop(T& item)
+	{
+		const size_t head = m_Head.load(std::memory_order_relaxed);
+
+		if (head == m_Tail.load(std::memory_order_acquire))
+			return false;
+
+		item = m_Items[head & (N - 1)];
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<T, N> m_Items;
+	alignas(64) std::atomic<size_t> m_Head;
+	alignas(64) std::atomic<size_t> m_Tail;
+};
@@ -1,61 +1,164 @@
 #include "robot.hpp"
+#include "dynamics.hpp"
 
+#include <cmath>
 
-Robot::Robot() : m_Pos{}, m_Vel{}, m_Acc{}
+
+Robot::Robot(const Method method)
+	: m_Method{ method }, m_Solver{}, m_Time{}, m_Pos{}, m_Vel{}, m_Acc{}, m_Mom{}, m_Monitor{}
 {
+	m_Solver.Reset(Vector{}, 0.0);
+	m_Monitor.Reset(Vector{});
 }
 
 void Robot::Update(const double dt)
 {
-	// Input torque
-	double trq1, trq2;
-	// Output acceleration
-	double a1, a2;
+	switch (m_Method)
+	{
+	case Method::Euler:
+		Advance<integrator::Euler>(dt);
+		break;
+	case Method::RK4:
+		Advance<integrator::RK4>(dt);
+		break;
+	case Method::RK38:
+		Advance<integrator::RK38>(dt);
+		break;
+	case Method::RK6:
+		Advance<integrator::RK6>(dt);
+		break;
+	case Method::DOPRI45:
+		AdvanceAdaptive(dt);
+		break;
+	case Method::Verlet:
+		AdvanceCanonical<symplectic::Verlet>(dt);
+		break;
+	case Method::Yoshida4:
+		AdvanceCanonical<symplectic::Yoshida4>(dt);
+		break;
+	case Method::Yoshida6:
+		AdvanceCanonical<symplectic::Yoshida6>(dt);
+		break;
+	case Method::Midpoint:
+		AdvanceCanonical<symplectic::Midpoint>(dt);
+		break;
+	case Method::BackwardEuler:
+		AdvanceImplicit<integrator::BackwardEuler>(dt);
+		break;
+	case Method::SDIRK2:
+		AdvanceImplicit<integrator::SDIRK2>(dt);
+		break;
+	}
 
-	// Rename important variables
-	const double q1 = m_Pos[0];
-	const double q2 = m_Pos[1];
-	const double w1 = m_Vel[0];
-	const double w2 = m_Vel[1];
-	constexpr double g = cfg::env::GRAVITY;
-	constexpr double m1 = cfg::link::MASS[0];
-	constexpr double m2 = cfg::link::MASS[1];
-	constexpr double L1 = cfg::link::LENGTH[0];
-	constexpr double L2 = cfg::link::LENGTH[1];
-	constexpr double u1 = cfg::joint::FRICTION[0];
-	constexpr double u2 = cfg::joint::FRICTION[1];
-
-	// Set input torque
-	
-	trq1 = -u1 * w1;
-	trq2 = -u2 * w2;
-
-	// Compute forward dynamics
-	const double cosq1 = cos(q1);
-	const double cosq2 = cos(q2);
-	const double sinq1 = sin(q1);
-	const double sinq2 = sin(q2);
-	const double cosq12 = cos(q1 + q2);
-	a1 = (trq1 - L1 * g * cosq1 * (m1 + m2) - L2 * g * m2 * cosq12 + L1 * L2 * m2 * w2 * sinq2 * (2 * w1 + w2)) / (L1 * L1 * (-m2 * cosq2 * cosq2 + m1 + m2)) + ((L2 + L1 * cosq2) * (L1 * L2 * m2 * sinq2 * w1 * w1 - trq2 + L2 * g * m2 * cosq12)) / (L1 * L1 * L2 * (-m2 * cosq2 * cosq2 + m1 + m2));
-	a2 = -((L2 + L1 * cosq2) * (trq1 - L1 * g * cosq1 * (m1 + m2) - L2 * g * m2 * cosq12 + L1 * L2 * m2 * w2 * sinq2 * (2 * w1 + w2))) / (L1 * L1 * L2 * (-m2 * cosq2 * cosq2 + m1 + m2)) - ((L1 * L2 * m2 * sinq2 * w1 * w1 - trq2 + L2 * g * m2 * cosq12) * (L1 * L1 * m1 + L1 * L1 * m2 + L2 * L2 * m2 + 2 * L1 * L2 * m2 * cosq2)) / (L1 * L1 * L2 * L2 * m2 * (-m2 * cosq2 * cosq2 + m1 + m2));
+	// One set of trig terms gives the new accelerations and the energy
+	m_Monitor.Update(Vector{ m_Pos[0], m_Pos[1], m_Vel[0], m_Vel[1] }, dt);
+	m_Acc = { m_Monitor.GetDerivative()[2], m_Monitor.GetDerivative()[3] };
+	m_Time += dt;
+}
+
+template <class Scheme>
+void Robot::Advance(const double dt)
+{
+	Vector dx;
+	const Vector x{ m_Pos[0], m_Pos[1], m_Vel[0], m_Vel[1] };
+	const Vector y = Scheme::Step([](const Vector& s) { return Derivative(s); }, x, dt, dx);
 
 	// Update joint states
-	m_Pos[0] = q1 + w1 * dt;
-	m_Pos[1] = q2 + w2 * dt;
-	m_Vel[0] = w1 + a1 * dt;
-	m_Vel[1] = w2 + a2 * dt;
-	m_Acc[0] = a1;
-	m_Acc[1] = a2;
+	m_Pos = { y[0], y[1] };
+	m_Vel = { y[2], y[3] };
+}
+
+void Robot::AdvanceAdaptive(const double dt)
+{
+	const double target = m_Time + dt;
+
+	// Step past the target and read the state off the dense output
+	while (m_Solver.GetTime() < target)
+	{
+		// Held where the solver gave up, e.g. on a state that is not finite
+		if (!m_Solver.Step([](const Vector& s) { return Derivative(s); }))
+			break;
+	}
+
+	const Vector y = m_Solver.GetTime() < target ? m_Solver.GetState() : m_Solver.Sample(target);
+
+	m_Pos = { y[0], y[1] };
+	m_Vel = { y[2], y[3] };
+}
+
+template <class Scheme>
+void Robot::AdvanceCanonical(const double dt)
+{
+	// Momenta stay authoritative so the map remains symplectic
+	const Vector z = Scheme::Step(Vector{ m_Pos[0], m_Pos[1], m_Mom[0], m_Mom[1] }, dt);
+	const Vector x = hamiltonian::FromCanonical(z);
+
+	m_Pos = { z[0], z[1] };
+	m_Mom = { z[2], z[3] };
+	m_Vel = { x[2], x[3] };
+}
+
+template <class Scheme>
+void Robot::AdvanceImplicit(const double dt)
+{
+	Vector dy;
+	const Vector x{ m_Pos[0], m_Pos[1], m_Vel[0], m_Vel[1] };
+	const Vector y = Scheme::Step(
+		[](const Vector& s) { return Derivative(s); },
+		[](const Vector& s) { return Jacobian(s); },
+		x, dt, dy
+	);
+
+	m_Pos = { y[0], y[1] };
+	m_Vel = { y[2], y[3] };
+}
+
+Vector Robot::Sample(const double t) const
+{
+	if (m_Method == Method::DOPRI45 && t >= m_Solver.GetStartTime() && t <= m_Solver.GetTime())
+		return m_Solver.Sample(t);
+
+	return Vector{ m_Pos[0], m_Pos[1], m_Vel[0], m_Vel[1] };
+}
+
+Vector Robot::Derivative(const Vector& x)
+{
+	double a1, a2;
+	dynamics::Accelerations(x[0], x[1], x[2], x[3], a1, a2);
+
+	return Vector{ x[2], x[3], a1, a2 };
+}
+
+Matrix Robot::Jacobian(const Vector& x)
+{
+	Matrix jac{};
+	jac[0][2] = 1.0;
+	jac[1][3] = 1.0;
+	dynamics::Jacobian(x[0], x[1], x[2], x[3], jac[2].data(), jac[3].data());
+
+	return jac;
 }
 
 void Robot::Restart()
 {
-	m_Pos = { 0.0, 0.0 };
-	m_Vel = { 0.0, 0.0 };
-	m_Acc = { 0.0, 0.0 };
+	SetState(Vector{});
 }
 
-Frame Robot::GetLinkFrames()
+void Robot::SetState(const Vector& x)
+{
+	const Vector z = hamiltonian::ToCanonical(x);
+	m_Monitor.Reset(x);
+
+	// Momenta too, the canonical schemes step from them rather than the velocities
+	m_Pos = { x[0], x[1] };
+	m_Vel = { x[2], x[3] };
+	m_Acc = { m_Monitor.GetDerivative()[2], m_Monitor.GetDerivative()[3] };
+	m_Mom = { z[2], z[3] };
+	m_Time = 0.0;
+	m_Solver.Reset(x, 0.0);
+}
+
+Frame Robot::GetLinkFrames() const
 {
 	const double cosq1 = cos(m_Pos[0]);
 	const double sinq1 = sin(m_Pos[0]);
@@ -80,7 +183,7 @@ Frame Robot::GetLinkFrames()
 	};
 }
 
-Frame Robot::GetJointFrames()
+Frame Robot::GetJointFrames() const
 {
 	const double q1 = m_Pos[0];
 	constexpr double L1 = cfg::link::LENGTH[0];
@@ -92,17 +195,52 @@ Frame Robot::GetJointFrames()
 	};
 }
 
-const State& Robot::GetPositions()
+const State& Robot::GetPositions() const
 {
 	return m_Pos;
 }
 
-const State& Robot::GetVelocities()
+const State& Robot::GetVelocities() const
 {
 	return m_Vel;
 }
 
-const State& Robot::GetAccelerations()
+const State& Robot::GetAccelerations() const
 {
 	return m_Acc;
 }
+
+State Robot::GetMomenta() const
+{
+	switch (m_Method)
+	{
+	case Method::Verlet:
+	case Method::Yoshida4:
+	case Method::Yoshida6:
+	case Method::Midpoint:
+		return m_Mom;
+	default:
+		const Vector z = hamiltonian::ToCanonical(Vector{ m_Pos[0], m_Pos[1], m_Vel[0], m_Vel[1] });
+		return State{ z[2], z[3] };
+	}
+}
+
+const Energy& Robot::GetEnergy() const
+{
+	return m_Monitor.GetEnergy();
+}
+
+const Monitor& Robot::GetMonitor() const
+{
+	return m_Monitor;
+}
+
+const integrator::DormandPrince& Robot::GetSolver() const
+{
+	return m_Solver;
+}
+
+double Robot::GetTime() const
+{
+	return m_Time;
+}
@@ -1,6 +1,9 @@
 #pragma once
 
-#include "Config.hpp"
+#include "config.hpp"
+#include "monitor.hpp"
+#include "integrator.hpp"
+#include "hamiltonian.hpp"
 
 #include <array>
 
@@ -14,22 +17,62 @@ struct Coord
 using Frame = std::array<Coord, 2>;
 using State = std::array<double, 2>;
 
+// Integration scheme used by Robot::Update
+enum class Method
+{
+	Euler,
+	RK4,
+	RK38,
+	RK6,
+	DOPRI45,
+	Verlet,
+	Yoshida4,
+	Yoshida6,
+	Midpoint,
+	BackwardEuler,
+	SDIRK2
+};
+
 class Robot
 {
 public:
-	Robot();
+	Robot(const Method method = Method::RK4);
 
 	void Update(const double dt);
 	void Restart();
+	// Start over from x = { q1, q2, w1, w2 } at time zero
+	void SetState(const Vector& x);
+	Vector Sample(const double t) const;
 
-	Frame GetLinkFrames();
-	Frame GetJointFrames();
-	const State& GetPositions();
-	const State& GetVelocities();
-	const State& GetAccelerations();
+	static Vector Derivative(const Vector& x);
+	static Matrix Jacobian(const Vector& x);
+
+	Frame GetLinkFrames() const;
+	Frame GetJointFrames() const;
+	const State& GetPositions() const;
+	const State& GetVelocities() const;
+	const State& GetAccelerations() const;
+	State GetMomenta() const;
+	const Energy& GetEnergy() const;
+	const Monitor& GetMonitor() const;
+	const integrator::DormandPrince& GetSolver() const;
+	double GetTime() const;
 
 private:
+	template <class Scheme>
+	void Advance(const double dt);
+	void AdvanceAdaptive(const double dt);
+	template <class Scheme>
+	void AdvanceCanonical(const double dt);
+	template <class Scheme>
+	void AdvanceImplicit(const double dt);
+
+	Method m_Method;
+	integrator::DormandPrince m_Solver;
+	double m_Time;
 	State m_Pos;
 	State m_Vel;
 	State m_Acc;
+	State m_Mom;
+	Monitor m_Monitor;
 };
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "section.hpp"
+#include "robot.hpp"
+#include "dynamics.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+	constexpr double PI = 3.14159265358979323846;
+
+	// Into [-pi, pi)
+	double Wrap(const double a)
+	{
+		return a - 2 * PI * std::floor((a + PI) / (2 * PI));
+	}
+}
+
+Section::Section(const Plane& plane)
+	: m_Event{ event::Linear(plane.normal, plane.offset, plane.direction, plane.periodic, event::Action::Callback) }
+{
+}
+
+void Section::Run(const Vector& x, const double duration, std::vector<Crossing>& crossings) const
+{
+	integrator::DormandPrince solver;
+	solver.Reset(x, 0.0);
+
+	event::Detector detector;
+	detector.Add(m_Event);
+
+	detector.Run(solver, [](const Vector& s) { return Robot::Derivative(s); }, duration, [&](const event::Hit& hit)
+	{
+		crossings.push_back(Crossing{ hit.time, hit.x });
+		return event::Action::Continue;
+	});
+}
+
+void Section::Write(std::ostream& out, const size_t index, const std::vector<Crossing>& crossings)
+{
+	for (const Crossing& c : crossings)
+	{
+		const double record[6] = { double(index), c.time, c.x[0], c.x[1], c.x[2], c.x[3] };
+		out.write(reinterpret_cast<const char*>(record), sizeof(record));
+	}
+}
+
+Vector Section::AtEnergy(const double e)
+{
+	// Straight links at rest hold only potential, (G1 + G2) sin(q1)
+	const double top = dynamics::G1_0 + dynamics::G2_0;
+
+	if (std::abs(e) > top)
+		throw std::invalid_argument("No state at rest with straight links has that energy.");
+
+	return Vector{ std::asin(e / top), 0.0, 0.0, 0.0 };
+}
+
+SectionImage::SectionImage(const int width, const int height,
+						   const int x_axis, const double x_min, const double x_max,
+						   const int y_axis, const double y_min, const double y_max)
+	: m_Width{ width }, m_Height{ height }, m_Axis{ x_axis, y_axis },
+	m_Min{ x_min, y_min }, m_Max{ x_max, y_max }, m_Count{ 0 }
+{
+	if (width <= 0 || height <= 0)
+		throw std::invalid_argument("Section image size must be positive.");
+	if (x_axis < 0 || x_axis > 3 || y_axis < 0 || y_axis > 3)
+		throw std::invalid_argument("Section image axes index { q1, q2, w1, w2 }.");
+
+	m_Bins.assign(size_t(width) * height, 0);
+}
+
+void SectionImage::Add(const Vector& x)
+{
+	int pixel[2];
+
+	for (int k = 0; k < 2; k++)
+	{
+		const int axis = m_Axis[k];
+		const double v = axis < 2 ? Wrap(x[axis]) : x[axis];
+		const double u = (v - m_Min[k]) / (m_Max[k] - m_Min[k]);
+
+		if (!(u >= 0.0 && u < 1.0))
+			return;
+
+		pixel[k] = int(u * (k == 0 ? m_Width : m_Height));
+	}
+
+	// Larger values on top
+	m_Bins[size_t(m_Height - 1 - pixel[1]) * m_Width + pixel[0]]++;
+	m_Count++;
+}
+
+void SectionImage::Add(const std::vector<Crossing>& crossings)
+{
+	for (const Crossing& c : crossings)
+		Add(c.x);
+}
+
+void SectionImage::GetPixels(std::vector<uint32_t>& pixels) const
+{
+	constexpr size_t stops = std::size(cfg::section::PALETTE) - 1;
+	const uint32_t most = std::max(1u, *std::max_element(m_Bins.begin(), m_Bins.end()));
+	const double range = std::log1p(double(most));
+
+	pixels.resize(m_Bins.size());
+
+	for (size_t i = 0; i < m_Bins.size(); i++)
+	{
+		const int* rgb = cfg::section::BACKGROUND;
+		int mixed[3];
+
+		if (m_Bins[i] > 0)
+		{
+			// A single hit is already visible, the palette spans log counts up to the densest bin
+			const double u = std::log1p(double(m_Bins[i])) / range * stops;
+			const size_t k = std::min(size_t(u), stops - 1);
+			const double f = u - k;
+
+			for (int j = 0; j < 3; j++)
+				mixed[j] = int(cfg::section::PALETTE[k][j] + f * (cfg::section::PALETTE[k + 1][j] - cfg::section::PALETTE[k][j]) + 0.5);
+
+			rgb = mixed;
+		}
+
+		pixels[i] = 0xFF000000u | uint32_t(rgb[0]) << 16 | uint32_t(rgb[1]) << 8 | uint32_t(rgb[2]);
+	}
+}
+
+void SectionImage::WritePpm(const std::string& path) const
+{
+	std::vector<uint32_t> pixels;
+	GetPixels(pixels);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << "P6\n" << m_Width << ' ' << m_Height << "\n255\n";
+
+	std::vector<uint8_t> row(size_t(m_Width) * 3);
+
+	for (int y = 0; y < m_Height; y++)
+	{
+		for (int x = 0; x < m_Width; x++)
+		{
+			for (int j = 0; j < 3; j++)
+				row[size_t(x) * 3 + j] = uint8_t(pixels[size_t(y) * m_Width + x] >> (16 - 8 * j));
+		}
+
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	if (!file)
+		throw std::runtime_error("Failed to write '" + path + "'.");
+}
+
+int SectionImage::GetWidth() const
+{
+	return m_Width;
+}
+
+int SectionImage::GetHeight() const
+{
+	return m_Height;
+}
+
+uint64_t SectionImage::GetCount() const
+{
+	return m_Count;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "pool.hpp"
+#include "config.hpp"
+#include "events.hpp"
+#include "integrator.hpp"
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+
+// Hyperplane in { q1, q2, w1, w2 } where normal . x = offset
+struct Plane
+{
+	Vector normal;
+	double offset;
+	// +1 keeps crossings with normal . x rising, -1 falling and 0 both
+	int direction;
+	// Compare modulo 2 pi, for planes through an angle
+	bool periodic;
+};
+
+// One pass of a trajectory through the plane
+struct Crossing
+{
+	double time;
+	Vector x;
+};
+
+// Poincare sections of the double pendulum. Trajectories are stepped by the
+// adaptive Dormand-Prince pair and the plane is an event::Linear, so every
+// crossing is pinned down on the step's dense output, costing no extra steps.
+class Section
+{
+public:
+	Section(const Plane& plane);
+
+	// Integrate from x for duration seconds, appending every crossing, or until the solver gives up
+	void Run(const Vector& x, const double duration, std::vector<Crossing>& crossings) const;
+
+	// Every start over the pool, handing sink(i, crossings) each finished trajectory in
+	// completion order. Calls to sink are serialised, so it may write to a shared file.
+	template <class F>
+	void Run(Pool& pool, const std::vector<Vector>& starts, const double duration, F&& sink) const
+	{
+		std::mutex mutex;
+
+		pool.For(starts.size(), [&](const size_t i)
+		{
+			std::vector<Crossing> crossings;
+			Run(starts[i], duration, crossings);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			sink(i, crossings);
+		});
+	}
+
+	// Records of six little endian doubles: start index, time, q1, q2, w1, w2
+	static void Write(std::ostream& out, const size_t index, const std::vector<Crossing>& crossings);
+	// At rest with link 2 in line with link 1, raised until the energy is e
+	static Vector AtEnergy(const double e);
+
+private:
+	event::Event m_Event;
+};
+
+// Density of section points over two state components, accumulated as they
+// arrive and coloured by log count
+class SectionImage
+{
+public:
+	SectionImage(const int width, const int height,
+				 const int x_axis, const double x_min, const double x_max,
+				 const int y_axis, const double y_min, const double y_max);
+
+	// Angles are wrapped into [-pi, pi) before binning
+	void Add(const Vector& x);
+	void Add(const std::vector<Crossing>& crossings);
+
+	// ARGB pixels, width per row, ready for a streaming texture
+	void GetPixels(std::vector<uint32_t>& pixels) const;
+	void WritePpm(const std::string& path) const;
+
+	int GetWidth() const;
+	int GetHeight() const;
+	uint64_t GetCount() const;
+
+private:
+	int m_Width;
+	int m_Height;
+	int m_Axis[2];
+	double m_Min[2];
+	double m_Max[2];
+	uint64_t m_Count;
+	std::vector<uint32_t> m_Bins;
+};
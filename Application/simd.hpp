@@ -0,0 +1,327 @@
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <immintrin.h>
+
+
+// Thin wrappers over SSE2, AVX2 and AVX-512 registers so scalar templates such
+// as the dynamics kernel instantiate unchanged on packs of lanes. SSE2 is the
+// x64 baseline, the wider ISAs exist when the translation unit enables them.
+namespace simd
+{
+	// Cache line alignment, enough for a full AVX-512 register
+	constexpr size_t ALIGNMENT = 64;
+
+	// Per-ISA primitives, each defining Reg, Mask, Scalar, WIDTH and the operations Pack uses
+	struct Sse2F64
+	{
+		using Reg = __m128d;
+		using Mask = __m128d;
+		using Scalar = double;
+		static constexpr size_t WIDTH = 2;
+
+		static Reg Set(const double x) { return _mm_set1_pd(x); }
+		static Reg Load(const double* p) { return _mm_load_pd(p); }
+		static void Store(double* p, const Reg a) { _mm_store_pd(p, a); }
+		static Reg Add(const Reg a, const Reg b) { return _mm_add_pd(a, b); }
+		static Reg Sub(const Reg a, const Reg b) { return _mm_sub_pd(a, b); }
+		static Reg Mul(const Reg a, const Reg b) { return _mm_mul_pd(a, b); }
+		static Reg Div(const Reg a, const Reg b) { return _mm_div_pd(a, b); }
+		static Reg Sqrt(const Reg a) { return _mm_sqrt_pd(a); }
+		static Reg Fma(const Reg a, const Reg b, const Reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+		static Reg Max(const Reg a, const Reg b) { return _mm_max_pd(a, b); }
+		static Mask Less(const Reg a, const Reg b) { return _mm_cmplt_pd(a, b); }
+		static Reg Select(const Mask m, const Reg a, const Reg b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+	};
+
+	struct Sse2F32
+	{
+		using Reg = __m128;
+		using Mask = __m128;
+		using Scalar = float;
+		static constexpr size_t WIDTH = 4;
+
+		static Reg Set(const float x) { return _mm_set1_ps(x); }
+		static Reg Load(const float* p) { return _mm_load_ps(p); }
+		static void Store(float* p, const Reg a) { _mm_store_ps(p, a); }
+		static Reg Add(const Reg a, const Reg b) { return _mm_add_ps(a, b); }
+		static Reg Sub(const Reg a, const Reg b) { return _mm_sub_ps(a, b); }
+		static Reg Mul(const Reg a, const Reg b) { return _mm_mul_ps(a, b); }
+		static Reg Div(const Reg a, const Reg b) { return _mm_div_ps(a, b); }
+		static Reg Sqrt(const Reg a) { return _mm_sqrt_ps(a); }
+		static Reg Fma(const Reg a, const Reg b, const Reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+		static Reg Max(const Reg a, const Reg b) { return _mm_max_ps(a, b); }
+		static Mask Less(const Reg a, const Reg b) { return _mm_cmplt_ps(a, b); }
+		static Reg Select(const Mask m, const Reg a, const Reg b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+	};
+
+#if defined(__AVX2__)
+	struct Avx2F64
+	{
+		using Reg = __m256d;
+		using Mask = __m256d;
+		using Scalar = double;
+		static constexpr size_t WIDTH = 4;
+
+		static Reg Set(const double x) { return _mm256_set1_pd(x); }
+		static Reg Load(const double* p) { return _mm256_load_pd(p); }
+		static void Store(double* p, const Reg a) { _mm256_store_pd(p, a); }
+		static Reg Add(const Reg a, const Reg b) { return _mm256_add_pd(a, b); }
+		static Reg Sub(const Reg a, const Reg b) { return _mm256_sub_pd(a, b); }
+		static Reg Mul(const Reg a, const Reg b) { return _mm256_mul_pd(a, b); }
+		static Reg Div(const Reg a, const Reg b) { return _mm256_div_pd(a, b); }
+		static Reg Sqrt(const Reg a) { return _mm256_sqrt_pd(a); }
+		static Reg Fma(const Reg a, const Reg b, const Reg c) { return _mm256_fmadd_pd(a, b, c); }
+		static Reg Max(const Reg a, const Reg b) { return _mm256_max_pd(a, b); }
+		static Mask Less(const Reg a, const Reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		static Reg Select(const Mask m, const Reg a, const Reg b) { return _mm256_blendv_pd(b, a, m); }
+	};
+
+	struct Avx2F32
+	{
+		using Reg = __m256;
+		using Mask = __m256;
+		using Scalar = float;
+		static constexpr size_t WIDTH = 8;
+
+		static Reg Set(const float x) { return _mm256_set1_ps(x); }
+		static Reg Load(const float* p) { return _mm256_load_ps(p); }
+		static void Store(float* p, const Reg a) { _mm256_store_ps(p, a); }
+		static Reg Add(const Reg a, const Reg b) { return _mm256_add_ps(a, b); }
+		static Reg Sub(const Reg a, const Reg b) { return _mm256_sub_ps(a, b); }
+		static Reg Mul(const Reg a, const Reg b) { return _mm256_mul_ps(a, b); }
+		static Reg Div(const Reg a, const Reg b) { return _mm256_div_ps(a, b); }
+		static Reg Sqrt(const Reg a) { return _mm256_sqrt_ps(a); }
+		static Reg Fma(const Reg a, const Reg b, const Reg c) { return _mm256_fmadd_ps(a, b, c); }
+		static Reg Max(const Reg a, const Reg b) { return _mm256_max_ps(a, b); }
+		static Mask Less(const Reg a, const Reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static Reg Select(const Mask m, const Reg a, const Reg b) { return _mm256_blendv_ps(b, a, m); }
+	};
+#endif
+
+#if defined(__AVX512F__)
+	struct Avx512F64
+	{
+		using Reg = __m512d;
+		using Mask = __mmask8;
+		using Scalar = double;
+		static constexpr size_t WIDTH = 8;
+
+		static Reg Set(const double x) { return _mm512_set1_pd(x); }
+		static Reg Load(const double* p) { return _mm512_load_pd(p); }
+		static void Store(double* p, const Reg a) { _mm512_store_pd(p, a); }
+		static Reg Add(const Reg a, const Reg b) { return _mm512_add_pd(a, b); }
+		static Reg Sub(const Reg a, const Reg b) { return _mm512_sub_pd(a, b); }
+		static Reg Mul(const Reg a, const Reg b) { return _mm512_mul_pd(a, b); }
+		static Reg Div(const Reg a, const Reg b) { return _mm512_div_pd(a, b); }
+		static Reg Sqrt(const Reg a) { return _mm512_sqrt_pd(a); }
+		static Reg Fma(const Reg a, const Reg b, const Reg c) { return _mm512_fmadd_pd(a, b, c); }
+		static Reg Max(const Reg a, const Reg b) { return _mm512_max_pd(a, b); }
+		static Mask Less(const Reg a, const Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+		static Reg Select(const Mask m, const Reg a, const Reg b) { return _mm512_mask_blend_pd(m, b, a); }
+	};
+
+	struct Avx512F32
+	{
+		using Reg = __m512;
+		using Mask = __mmask16;
+		using Scalar = float;
+		static constexpr size_t WIDTH = 16;
+
+		static Reg Set(const float x) { return _mm512_set1_ps(x); }
+		static Reg Load(const float* p) { return _mm512_load_ps(p); }
+		static void Store(float* p, const Reg a) { _mm512_store_ps(p, a); }
+		static Reg Add(const Reg a, const Reg b) { return _mm512_add_ps(a, b); }
+		static Reg Sub(const Reg a, const Reg b) { return _mm512_sub_ps(a, b); }
+		static Reg Mul(const Reg a, const Reg b) { return _mm512_mul_ps(a, b); }
+		static Reg Div(const Reg a, const Reg b) { return _mm512_div_ps(a, b); }
+		static Reg Sqrt(const Reg a) { return _mm512_sqrt_ps(a); }
+		static Reg Fma(const Reg a, const Reg b, const Reg c) { return _mm512_fmadd_ps(a, b, c); }
+		static Reg Max(const Reg a, const Reg b) { return _mm512_max_ps(a, b); }
+		static Mask Less(const Reg a, const Reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+		static Reg Select(const Mask m, const Reg a, const Reg b) { return _mm512_mask_blend_ps(m, b, a); }
+	};
+#endif
+
+	// A register of lanes behaving like a number, scalars broadcast on use
+	template <class Isa>
+	struct Pack
+	{
+		using Reg = typename Isa::Reg;
+		using Scalar = typename Isa::Scalar;
+		static constexpr size_t WIDTH = Isa::WIDTH;
+
+		Reg v;
+
+		Pack() = default;
+		Pack(const Reg r) : v{ r } {}
+		Pack(const double x) : v{ Isa::Set(Scalar(x)) } {}
+
+		static Pack Load(const Scalar* p) { return Isa::Load(p); }
+		void Store(Scalar* p) const { Isa::Store(p, v); }
+
+		Pack& operator+=(const Pack& b) { v = Isa::Add(v, b.v); return *this; }
+		Pack& operator-=(const Pack& b) { v = Isa::Sub(v, b.v); return *this; }
+		Pack& operator*=(const Pack& b) { v = Isa::Mul(v, b.v); return *this; }
+		Pack& operator/=(const Pack& b) { v = Isa::Div(v, b.v); return *this; }
+	};
+
+	template <class Isa> inline Pack<Isa> operator+(const Pack<Isa>& a, const Pack<Isa>& b) { return Isa::Add(a.v, b.v); }
+	template <class Isa> inline Pack<Isa> operator-(const Pack<Isa>& a, const Pack<Isa>& b) { return Isa::Sub(a.v, b.v); }
+	template <class Isa> inline Pack<Isa> operator*(const Pack<Isa>& a, const Pack<Isa>& b) { return Isa::Mul(a.v, b.v); }
+	template <class Isa> inline Pack<Isa> operator/(const Pack<Isa>& a, const Pack<Isa>& b) { return Isa::Div(a.v, b.v); }
+	template <class Isa> inline Pack<Isa> operator-(const Pack<Isa>& a) { return Isa::Sub(Isa::Set(0), a.v); }
+
+	// Mixed forms so folded double constants from the scalar code broadcast
+	template <class Isa> inline Pack<Isa> operator+(const Pack<Isa>& a, const double b) { return a + Pack<Isa>(b); }
+	template <class Isa> inline Pack<Isa> operator-(const Pack<Isa>& a, const double b) { return a - Pack<Isa>(b); }
+	template <class Isa> inline Pack<Isa> operator*(const Pack<Isa>& a, const double b) { return a * Pack<Isa>(b); }
+	template <class Isa> inline Pack<Isa> operator/(const Pack<Isa>& a, const double b) { return a / Pack<Isa>(b); }
+	template <class Isa> inline Pack<Isa> operator+(const double a, const Pack<Isa>& b) { return Pack<Isa>(a) + b; }
+	template <class Isa> inline Pack<Isa> operator-(const double a, const Pack<Isa>& b) { return Pack<Isa>(a) - b; }
+	template <class Isa> inline Pack<Isa> operator*(const double a, const Pack<Isa>& b) { return Pack<Isa>(a) * b; }
+	template <class Isa> inline Pack<Isa> operator/(const double a, const Pack<Isa>& b) { return Pack<Isa>(a) / b; }
+
+	template <class Isa>
+	inline Pack<Isa> Fma(const Pack<Isa>& a, const Pack<Isa>& b, const Pack<Isa>& c)
+	{
+		return Isa::Fma(a.v, b.v, c.v);
+	}
+
+	template <class Isa>
+	inline Pack<Isa> Select(const typename Isa::Mask m, const Pack<Isa>& a, const Pack<Isa>& b)
+	{
+		return Isa::Select(m, a.v, b.v);
+	}
+
+	template <class Isa>
+	inline typename Isa::Mask Less(const Pack<Isa>& a, const Pack<Isa>& b)
+	{
+		return Isa::Less(a.v, b.v);
+	}
+
+	template <class Isa>
+	inline Pack<Isa> Sqrt(const Pack<Isa>& a)
+	{
+		return Isa::Sqrt(a.v);
+	}
+
+	template <class Isa>
+	inline Pack<Isa> Abs(const Pack<Isa>& a)
+	{
+		return Isa::Max(a.v, Isa::Sub(Isa::Set(0), a.v));
+	}
+
+	// Nearest integer by the round-to-nearest-even shift, valid below 2^51 (2^22 for float)
+	template <class Isa>
+	inline Pack<Isa> Round(const Pack<Isa>& a)
+	{
+		using Scalar = typename Isa::Scalar;
+		const Pack<Isa> shift = sizeof(Scalar) == 8 ? 6755399441055744.0 : 12582912.0;
+		return (a + shift) - shift;
+	}
+
+	// Cody-Waite reduction by pi/2 in three parts, exact with or without FMA,
+	// and the Cephes minimax polynomials on [-pi/4, pi/4]. The quadrant logic
+	// stays in floating point so no integer lanes are needed.
+	template <class Isa>
+	inline void SinCos(const Pack<Isa>& x, Pack<Isa>& s, Pack<Isa>& c)
+	{
+		using P = Pack<Isa>;
+
+		if constexpr (sizeof(typename Isa::Scalar) == 8)
+		{
+			const P q = Round(x * 0.63661977236758134308);
+			const P r = Fma(q, P(-5.39030285815811905290e-15), Fma(q, P(-7.54978941586159635335e-8), Fma(q, P(-1.57079625129699707031), x)));
+			const P r2 = r * r;
+
+			P ps = Fma(r2, P(1.58962301576546568060e-10), P(-2.50507477628578072866e-8));
+			ps = Fma(ps, r2, P(2.75573136213857245213e-6));
+			ps = Fma(ps, r2, P(-1.98412698295895385996e-4));
+			ps = Fma(ps, r2, P(8.33333333332211858878e-3));
+			ps = Fma(ps, r2, P(-1.66666666666666307295e-1));
+			ps = Fma(ps * r2, r, r);
+
+			P pc = Fma(r2, P(-1.13585365213876817300e-11), P(2.08757008419747316778e-9));
+			pc = Fma(pc, r2, P(-2.75573141792967388112e-7));
+			pc = Fma(pc, r2, P(2.48015872888517045348e-5));
+			pc = Fma(pc, r2, P(-1.38888888888730564116e-3));
+			pc = Fma(pc, r2, P(4.16666666666665929218e-2));
+			pc = Fma(pc * r2, r2, Fma(r2, P(-0.5), P(1.0)));
+
+			// Quadrant k = q mod 4 in 0..3
+			P k = q - 4.0 * Round(q * 0.25);
+			k = Select(Less(k, P(0.0)), k + 4.0, k);
+			const auto odd = Less(P(0.25), Abs(k - 2.0 * Round(k * 0.5)));
+
+			const P sn = Select(odd, pc, ps);
+			const P cs = Select(odd, ps, pc);
+			s = Select(Less(P(1.5), k), -sn, sn);
+			c = Select(Less(Abs(k - 1.5), P(1.0)), -cs, cs);
+		}
+		else
+		{
+			const P q = Round(x * 0.63661977236758134308);
+			const P r = Fma(q, P(-7.54978995489188216e-8), Fma(q, P(-4.837512969970703125e-4), Fma(q, P(-1.5703125), x)));
+			const P r2 = r * r;
+
+			P ps = Fma(r2, P(-1.9515295891e-4), P(8.3321608736e-3));
+			ps = Fma(ps, r2, P(-1.6666654611e-1));
+			ps = Fma(ps * r2, r, r);
+
+			P pc = Fma(r2, P(2.443315711809948e-5), P(-1.388731625493765e-3));
+			pc = Fma(pc, r2, P(4.166664568298827e-2));
+			pc = Fma(pc * r2, r2, Fma(r2, P(-0.5), P(1.0)));
+
+			P k = q - 4.0 * Round(q * 0.25);
+			k = Select(Less(k, P(0.0)), k + 4.0, k);
+			const auto odd = Less(P(0.25), Abs(k - 2.0 * Round(k * 0.5)));
+
+			const P sn = Select(odd, pc, ps);
+			const P cs = Select(odd, ps, pc);
+			s = Select(Less(P(1.5), k), -sn, sn);
+			c = Select(Less(Abs(k - 1.5), P(1.0)), -cs, cs);
+		}
+	}
+
+	// Widest pack the translation unit was compiled for
+#if defined(__AVX512F__)
+	using F64 = Pack<Avx512F64>;
+	using F32 = Pack<Avx512F32>;
+#elif defined(__AVX2__)
+	using F64 = Pack<Avx2F64>;
+	using F32 = Pack<Avx2F32>;
+#else
+	using F64 = Pack<Sse2F64>;
+	using F32 = Pack<Sse2F32>;
+#endif
+
+	template <class Real>
+	using Native = std::conditional_t<sizeof(Real) == 8, F64, F32>;
+
+	// Aligned allocator so std::vector storage can be loaded a register at a time
+	template <class T>
+	struct Allocator
+	{
+		using value_type = T;
+
+		Allocator() = default;
+		template <class U> Allocator(const Allocator<U>&) {}
+
+		T* allocate(const size_t n)
+		{
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(ALIGNMENT)));
+		}
+
+		void deallocate(T* p, const size_t)
+		{
+			::operator delete(p, std::align_val_t(ALIGNMENT));
+		}
+
+		template <class U> bool operator==(const Allocator<U>&) const { return true; }
+		template <class U> bool operator!=(const Allocator<U>&) const { return false; }
+	};
+}
@@ -0,0 +1,5 @@
+#include "stepping.hpp"
+
+
+// Baseline level, every x64 CPU has SSE2
+const kernels::Table kernels::SSE2 = stepping::MakeTable<simd::Pack<simd::Sse2F64>, simd::Pack<simd::Sse2F32>>(kernels::Level::SSE2);
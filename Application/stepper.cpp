@@ -0,0 +1,49 @@
+#include "stepper.hpp"
+
+
+Stepper::Stepper() : m_Accumulator{}, m_Ratio{}
+{
+}
+
+int Stepper::Consume(const double dt)
+{
+	constexpr double h = 1.0 / cfg::sim::RATE;
+
+	int steps = 0;
+	m_Accumulator += dt;
+
+	while (m_Accumulator >= h && steps < cfg::sim::MAX_STEPS)
+	{
+		m_Accumulator -= h;
+		steps++;
+	}
+
+	// Drop whatever could not be caught up so a stall cannot snowball
+	if (m_Accumulator >= h)
+		m_Accumulator = 0.0;
+
+	// Smooth over roughly a tenth of a second of wall time
+	if (dt > 0.0)
+	{
+		const double alpha = dt / (dt + 0.1);
+		m_Ratio += alpha * (steps * h / dt - m_Ratio);
+	}
+
+	return steps;
+}
+
+void Stepper::Reset()
+{
+	m_Accumulator = 0.0;
+	m_Ratio = 0.0;
+}
+
+double Stepper::GetStepSize() const
+{
+	return 1.0 / cfg::sim::RATE;
+}
+
+double Stepper::GetRatio() const
+{
+	return m_Ratio;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "config.hpp"
+
+
+// Fixed-step accumulator decoupling physics from frame time
+class Stepper
+{
+public:
+	Stepper();
+
+	template <class Model>
+	int Advance(Model& model, const double dt)
+	{
+		const int steps = Consume(dt);
+		const double h = GetStepSize();
+
+		for (int i = 0; i < steps; i++)
+			model.Update(h);
+
+		return steps;
+	}
+
+	template <class Model>
+	void Step(Model& model)
+	{
+		model.Update(GetStepSize());
+	}
+
+	void Reset();
+
+	double GetStepSize() const;
+	double GetRatio() const;
+
+private:
+	int Consume(const double dt);
+
+	double m_Accumulator;
+	double m_Ratio;
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "simd.hpp"
+#include "kernel.hpp"
+#include "dynamics.hpp"
+
+
+// Kernel bodies behind kernels::Table, included only by the per-ISA translation
+// units. Everything here is instantiated on that unit's own pack types, so no
+// inline function compiled for a wider ISA can be shared with the baseline.
+namespace stepping
+{
+	// Packs stepped together so the sincos and division latencies overlap
+	constexpr int INTERLEAVE = 2;
+
+	template <class P>
+	inline void Derivative(const P x[4], P dx[4])
+	{
+		dx[0] = x[2];
+		dx[1] = x[3];
+		dynamics::Accelerations(x[0], x[1], x[2], x[3], dx[2], dx[3]);
+	}
+
+	template <class P>
+	inline void Step(P x[INTERLEAVE][4], const P& h)
+	{
+		const P half = h * 0.5;
+		const P sixth = h * (1.0 / 6.0);
+		P k[INTERLEAVE][4];
+		P y[INTERLEAVE][4];
+		P sum[INTERLEAVE][4];
+
+		for (int b = 0; b < INTERLEAVE; b++)
+		{
+			Derivative(x[b], k[b]);
+
+			for (int j = 0; j < 4; j++)
+			{
+				sum[b][j] = k[b][j];
+				y[b][j] = x[b][j] + half * k[b][j];
+			}
+		}
+
+		for (int b = 0; b < INTERLEAVE; b++)
+		{
+			Derivative(y[b], k[b]);
+
+			for (int j = 0; j < 4; j++)
+			{
+				sum[b][j] += 2.0 * k[b][j];
+				y[b][j] = x[b][j] + half * k[b][j];
+			}
+		}
+
+		for (int b = 0; b < INTERLEAVE; b++)
+		{
+			Derivative(y[b], k[b]);
+
+			for (int j = 0; j < 4; j++)
+			{
+				sum[b][j] += 2.0 * k[b][j];
+				y[b][j] = x[b][j] + h * k[b][j];
+			}
+		}
+
+		for (int b = 0; b < INTERLEAVE; b++)
+		{
+			Derivative(y[b], k[b]);
+
+			for (int j = 0; j < 4; j++)
+				x[b][j] += sixth * (sum[b][j] + k[b][j]);
+		}
+	}
+
+	template <class P>
+	void Ensemble(typename P::Scalar* const state[4], const size_t size, const double h, const int steps)
+	{
+		constexpr size_t W = P::WIDTH;
+		static_assert(kernels::BLOCK % (W * INTERLEAVE) == 0, "Block must hold whole interleaved packs");
+
+		// Each block stays in registers for all the steps before moving on
+		for (size_t i = 0; i < size; i += W * INTERLEAVE)
+		{
+			P x[INTERLEAVE][4];
+
+			for (int b = 0; b < INTERLEAVE; b++)
+			{
+				for (int j = 0; j < 4; j++)
+					x[b][j] = P::Load(state[j] + i + b * W);
+			}
+
+			for (int n = 0; n < steps; n++)
+				Step(x, P(h));
+
+			for (int b = 0; b < INTERLEAVE; b++)
+			{
+				for (int j = 0; j < 4; j++)
+					x[b][j].Store(state[j] + i + b * W);
+			}
+		}
+	}
+
+	// State then the four tangent vectors, vector c at 4 + 4c
+	constexpr int TANGENT = 20;
+
+	// The state and its tangent vectors under the linearised flow J = [0 I; da]
+	template <class P>
+	inline void Variational(const P y[TANGENT], P dy[TANGENT])
+	{
+		P da1[4], da2[4];
+		dy[0] = y[2];
+		dy[1] = y[3];
+		dynamics::Jacobian(dynamics::Angles(y[0], y[1]), y[2], y[3], dy[2], dy[3], da1, da2);
+
+		for (int c = 4; c < TANGENT; c += 4)
+		{
+			dy[c] = y[c + 2];
+			dy[c + 1] = y[c + 3];
+			dy[c + 2] = da1[0] * y[c] + da1[1] * y[c + 1] + da1[2] * y[c + 2] + da1[3] * y[c + 3];
+			dy[c + 3] = da2[0] * y[c] + da2[1] * y[c + 1] + da2[2] * y[c + 2] + da2[3] * y[c + 3];
+		}
+	}
+
+	// RK4 over state and tangents together, so the tangents see the same stages as the state
+	template <class P>
+	inline void StepVariational(P y[TANGENT], const P& h)
+	{
+		const P half = h * 0.5;
+		const P sixth = h * (1.0 / 6.0);
+		P k[TANGENT];
+		P z[TANGENT];
+		P sum[TANGENT];
+
+		Variational(y, k);
+
+		for (int j = 0; j < TANGENT; j++)
+		{
+			sum[j] = k[j];
+			z[j] = y[j] + half * k[j];
+		}
+
+		Variational(z, k);
+
+		for (int j = 0; j < TANGENT; j++)
+		{
+			sum[j] += 2.0 * k[j];
+			z[j] = y[j] + half * k[j];
+		}
+
+		Variational(z, k);
+
+		for (int j = 0; j < TANGENT; j++)
+		{
+			sum[j] += 2.0 * k[j];
+			z[j] = y[j] + h * k[j];
+		}
+
+		Variational(z, k);
+
+		for (int j = 0; j < TANGENT; j++)
+			y[j] += sixth * (sum[j] + k[j]);
+	}
+
+	// Modified Gram-Schmidt on the tangent vectors in order, leaving each one's stretch in norm
+	template <class P>
+	inline void Orthonormalise(P y[TANGENT], P norm[4])
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			P* v = y + 4 + 4 * c;
+
+			for (int b = 0; b < c; b++)
+			{
+				const P* u = y + 4 + 4 * b;
+				const P d = u[0] * v[0] + u[1] * v[1] + u[2] * v[2] + u[3] * v[3];
+
+				for (int j = 0; j < 4; j++)
+					v[j] -= d * u[j];
+			}
+
+			norm[c] = Sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+			const P inv = 1.0 / norm[c];
+
+			for (int j = 0; j < 4; j++)
+				v[j] *= inv;
+		}
+	}
+
+	template <class P>
+	void Lyapunov(double* const state[4], double* const tangent[16], double* const sums[4],
+				  const size_t size, const double h, const int steps, const int renorm)
+	{
+		constexpr size_t W = P::WIDTH;
+		static_assert(kernels::BLOCK % W == 0, "Block must hold whole packs");
+
+		for (size_t i = 0; i < size; i += W)
+		{
+			P y[TANGENT];
+
+			for (int j = 0; j < 4; j++)
+				y[j] = P::Load(state[j] + i);
+
+			for (int j = 0; j < 16; j++)
+				y[4 + j] = P::Load(tangent[j] + i);
+
+			for (int n = 1; n <= steps; n++)
+			{
+				StepVariational(y, P(h));
+
+				// Often enough that the tangents never collapse onto the leading direction
+				if (n % renorm != 0 && n != steps)
+					continue;
+
+				P norm[4];
+				alignas(simd::ALIGNMENT) double lanes[W];
+				Orthonormalise(y, norm);
+
+				for (int c = 0; c < 4; c++)
+				{
+					norm[c].Store(lanes);
+
+					for (size_t l = 0; l < W; l++)
+						sums[c][i + l] += std::log(lanes[l]);
+				}
+			}
+
+			for (int j = 0; j < 4; j++)
+				y[j].Store(state[j] + i);
+
+			for (int j = 0; j < 16; j++)
+				y[4 + j].Store(tangent[j] + i);
+		}
+	}
+
+	template <class F64, class F32>
+	constexpr kernels::Table MakeTable(const kernels::Level level)
+	{
+		return kernels::Table{ level, F64::WIDTH, F32::WIDTH, &Ensemble<F64>, &Ensemble<F32>, &Lyapunov<F64> };
+	}
+}
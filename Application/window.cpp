@@ -1,17 +1,33 @@
 #include "Font.hpp"
 #include "window.hpp"
+#include "draw.hpp"
+
+#include <cstdio>
 
 #define ThrowRuntime(brief, detail) \
 	throw std::runtime_error(std::string(brief) + "\n\n(" + std::string(detail) + ')')
 
 
+// Three significant figures, drift spans many orders of magnitude
+static std::string Format(const double value)
+{
+	char text[32];
+	std::snprintf(text, sizeof(text), "%.3g", value);
+	return text;
+}
+
+
 Window::Window()
 	: m_Width{}, m_Height{}, m_CentreX{}, m_CentreY{},
-	m_DeltaTime{}, m_DeltaTimeSim{}, m_DeltaTimeInfo{},
-	m_StepSim{ false }, m_StepInfo{ false }, m_OneStep{ false },
-	m_Quit{ false }, m_Pause{ false }, m_Robot{},
-	m_Texture{}, m_TextureSim{}, m_TextureInfo{},
-	m_TextureArea{}, m_TextureAreaSim{}, m_TextureAreaInfo{}
+	m_DeltaTime{}, m_DeltaTimeInfo{}, m_StepInfo{ false },
+	m_Fresh{ false }, m_Idle{ false }, m_VSync{ false }, m_Quit{ false },
+	m_Explore{ false },
+#if PENDULUM_PROFILE
+	m_Profile{ false },
+#endif
+	m_Pressed{ false }, m_Dragged{ false }, m_Press{}, m_Mouse{}, m_Physics{},
+	m_Pacer{ cfg::win::FRAME_RATE, cfg::win::SPIN_TIME }, m_Explorer{},
+	m_MapTexture{ nullptr }, m_Textures{}, m_TextureAreas{}
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 		ThrowRuntime("Failed to initialise SDL video.", SDL_GetError());
@@ -33,12 +49,18 @@ Window::Window()
 
 	m_Renderer = SDL_CreateRenderer(
 		m_Window, -1,
-		SDL_RENDERER_ACCELERATED
+		SDL_RENDERER_ACCELERATED | (cfg::win::VSYNC ? SDL_RENDERER_PRESENTVSYNC : 0)
 	);
 
 	if (m_Renderer == nullptr)
 		ThrowRuntime("Failed to create SDL renderer.", SDL_GetError());
 
+	// Fall back to deadline pacing when the driver ignores the vsync request
+	SDL_RendererInfo info;
+
+	if (SDL_GetRendererInfo(m_Renderer, &info) == 0)
+		m_VSync = (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+
 	SDL_RWops* font_rw = SDL_RWFromConstMem(
 		CaskaydiaCoveNerdFont_Regular_ttf,
 		CaskaydiaCoveNerdFont_Regular_ttf_len
@@ -58,9 +80,12 @@ Window::~Window()
 	TTF_CloseFont(m_Font);
 	TTF_Quit();
 
-	SDL_DestroyTexture(m_Texture);
-	SDL_DestroyTexture(m_TextureSim);
-	SDL_DestroyTexture(m_TextureInfo);
+	for (SDL_Texture* texture : m_Textures)
+		SDL_DestroyTexture(texture);
+
+	if (m_MapTexture != nullptr)
+		SDL_DestroyTexture(m_MapTexture);
+
 	SDL_DestroyRenderer(m_Renderer);
 	SDL_DestroyWindow(m_Window);
 	SDL_Quit();
@@ -69,24 +94,50 @@ Window::~Window()
 void Window::Run()
 {
 	m_Time = std::chrono::steady_clock::now();
-	m_TimeSim = std::chrono::steady_clock::now();
 	m_TimeInfo = std::chrono::steady_clock::now();
+	m_Physics.Start();
+	m_Pacer.Reset();
+	PROFILE_THREAD("render");
 
 	while (!m_Quit)
 	{
+		PROFILE_SCOPE(prof::Phase::Frame);
 		UpdateInternals();
 		UpdateRobot();
 		RenderBackground();
-		RenderLinks();
-		RenderJoints();
+
+		if (m_Explore)
+		{
+			RenderMap();
+		}
+		else
+		{
+			RenderLinks();
+			RenderJoints();
+		}
+
 		RenderInfo();
 		HandleEvents();
-		SDL_RenderPresent(m_Renderer);
+
+		{
+			PROFILE_SCOPE(prof::Phase::Present);
+			SDL_RenderPresent(m_Renderer);
+		}
+
+		// With vsync the present paces the loop, so jitter is the spread of present to present intervals
+		if (!m_VSync)
+			m_Pacer.Wait();
+		else
+			m_Pacer.Mark(!m_Idle);
 	}
+
+	m_Physics.Stop();
 }
 
 void Window::UpdateInternals()
 {
+	PROFILE_SCOPE(prof::Phase::UpdateInternals);
+
 	SDL_GetWindowSize(m_Window, &m_Width, &m_Height);
 	m_CentreX = (double)m_Width / 2;
 	m_CentreY = (double)m_Height / 2;
@@ -94,22 +145,14 @@ void Window::UpdateInternals()
 	Time now = std::chrono::steady_clock::now();
 
 	auto since = std::chrono::duration_cast<nano>(now - m_Time);
-	auto since_sim = std::chrono::duration_cast<nano>(now - m_TimeSim);
 	auto since_info = std::chrono::duration_cast<nano>(now - m_TimeInfo);
 
 	double dt = since.count() / 1e9;
-	double dt_sim = since_sim.count() / 1e9;
 	double dt_info = since_info.count() / 1e9;
 
 	m_Time = now;
 	m_DeltaTime = dt;
 
-	if (dt_sim > cfg::win::SIM_TIME)
-	{
-		m_TimeSim = now;
-		m_StepSim = true;
-		m_DeltaTimeSim = dt_sim;
-	}
 	if (dt_info > cfg::win::INFO_TIME)
 	{
 		m_TimeInfo = now;
@@ -120,198 +163,153 @@ void Window::UpdateInternals()
 
 void Window::UpdateRobot()
 {
-	if (m_StepSim)
-	{
-		if (m_OneStep)
-		{
-			m_Robot.Update(m_DeltaTime);
-			m_OneStep = false;
-			m_Pause = true;
-		}
-		else
-		if (!m_Pause)
-		{
-			m_Robot.Update(m_DeltaTime);
-		}
-		m_StepSim = false;
-	}
+	PROFILE_SCOPE(prof::Phase::UpdateRobot);
+
+	m_Fresh = m_Physics.Update();
 }
 
 void Window::RenderBackground()
 {
+	PROFILE_SCOPE(prof::Phase::RenderBackground);
+
 	SetColour(cfg::col::GREY);
 	SDL_RenderClear(m_Renderer);
 }
 
 void Window::RenderLinks()
 {
-	auto DrawRectangle = [this](const double x,
-								const double y,
-								const double l,
-								const double w,
-								const double a) -> void
-		{
-			int n_points = 0;
-			std::array<SDL_Point, cfg::buf::MAX_OUTLINE_SIZE> outline{};
-
-			int pxl, pyl, pxr, pyr;
-			const double inc = 1 / w;
-			const double cosa = cos(a);
-			const double sina = sin(a);
-			const double w_cosa = w * cosa;
-			const double w_sina = w * sina;
-			const double nw_cosa = -w_cosa;
-			const double nw_sina = -w_sina;
-			const double l_2_cosa = l / 2 * cosa;
-			const double l_2_sina = l / 2 * sina;
-			const double l_2_cosa_px = l_2_cosa + x;
-			const double l_2_sina_py = l_2_sina + y;
-			const double nl_2_cosa_px = -l_2_cosa + x;
-			const double nl_2_sina_py = -l_2_sina + y;
-			SetColour(cfg::link::COLOUR);
-
-			for (double t = -0.5; t < 0.5; t += inc)
-			{
-				pxl = (int)(l_2_cosa_px + nw_sina * t);
-				pyl = (int)(l_2_sina_py + w_cosa * t);
-				pxr = (int)(nl_2_cosa_px + nw_sina * t);
-				pyr = (int)(nl_2_sina_py + w_cosa * t);
-				outline[n_points++] = SDL_Point{ pxl, pyl };
-				outline[n_points++] = SDL_Point{ pxr, pyr };
-				SDL_RenderDrawLine(m_Renderer, pxl, pyl, pxr, pyr);
-			}
+	PROFILE_SCOPE(prof::Phase::RenderLinks);
 
-			SetColour(cfg::col::BLACK);
-			SDL_RenderDrawPoints(m_Renderer, outline.data(), n_points);
-			const double w_2_cosa = w_cosa / 2;
-			const double w_2_sina = w_sina / 2;
-			const double nw_2_cosa = -w_2_cosa;
-			const double nw_2_sina = -w_2_sina;
-			pxl = (int)(l_2_cosa_px + nw_2_sina);
-			pyl = (int)(l_2_sina_py + w_2_cosa);
-			pxr = (int)(nl_2_cosa_px + nw_2_sina);
-			pyr = (int)(nl_2_sina_py + w_2_cosa);
-			SDL_RenderDrawLine(m_Renderer, pxl, pyl, pxr, pyr);
-			pxl = (int)(l_2_cosa_px + w_2_sina);
-			pyl = (int)(l_2_sina_py + nw_2_cosa);
-			pxr = (int)(nl_2_cosa_px + w_2_sina);
-			pyr = (int)(nl_2_sina_py + nw_2_cosa);
-			SDL_RenderDrawLine(m_Renderer, pxl, pyl, pxr, pyr);
-		};
-
-	constexpr auto w1 = cfg::link::WIDTH[0] * 1000.0;
-	constexpr auto w2 = cfg::link::WIDTH[1] * 1000.0;
-	constexpr auto l1 = cfg::link::LENGTH[0] * 1000.0;
-	constexpr auto l2 = cfg::link::LENGTH[1] * 1000.0;
-	
-	const Frame links = m_Robot.GetLinkFrames();
-	const Coord coord1 = RobotToWindowFrame(links[0]);
-	const Coord coord2 = RobotToWindowFrame(links[1]);
-
-	const State& angles = m_Robot.GetPositions();
-	const double a1 = -angles[0];
-	const double a2 = -angles[0] - angles[1];
-
-	DrawRectangle(coord1.x, coord1.y, l1, w1, a1);
-	DrawRectangle(coord2.x, coord2.y, l2, w2, a2);
+	for (const Segment& segment : m_Physics.GetSnapshot().segments)
+	{
+		const Coord coord = RobotToWindowFrame(segment.centre);
+		DrawRectangle(m_Renderer, coord.x, coord.y, segment.length * 1000.0, segment.width * 1000.0, -segment.angle);
+	}
 }
 
 void Window::RenderJoints()
 {
-	auto DrawCircle = [this](const double x,
-							 const double y,
-							 const double r) -> void
-		{
-			int n_points = 0;
-			std::array<SDL_Point, cfg::buf::MAX_OUTLINE_SIZE> outline{};
+	PROFILE_SCOPE(prof::Phase::RenderJoints);
 
-			const double inc = 1 / r;
-			SetColour(cfg::joint::COLOUR);
+	for (const Segment& segment : m_Physics.GetSnapshot().segments)
+	{
+		const Coord coord = RobotToWindowFrame(segment.joint);
+		DrawCircle(m_Renderer, coord.x, coord.y, segment.radius * 1000.0);
+	}
+}
 
-			for (double a = 0.0; a < M_PI; a += inc)
-			{
-				const double rsina = r * sin(a);
-				const int px = (int)(x + r * cos(a));
-				const int py1 = (int)(y + rsina);
-				const int py2 = (int)(y - rsina);
-				outline[n_points++] = SDL_Point{ px, py1 };
-				outline[n_points++] = SDL_Point{ px, py2 };
-				SDL_RenderDrawLine(m_Renderer, px, py1, px, py2);
-			}
+void Window::RenderMap()
+{
+	PROFILE_SCOPE(prof::Phase::RenderMap);
 
-			SetColour(cfg::col::BLACK);
-			SDL_RenderDrawPoints(m_Renderer, outline.data(), n_points);
-		};
+	if (m_Width <= 0 || m_Height <= 0)
+		return;
 
-	constexpr auto r1 = cfg::joint::RADIUS[0] * 1000.0;
-	constexpr auto r2 = cfg::joint::RADIUS[1] * 1000.0;
+	if (m_Explorer->GetWidth() != m_Width || m_Explorer->GetHeight() != m_Height)
+	{
+		m_Explorer->Resize(m_Width, m_Height);
+
+		if (m_MapTexture != nullptr)
+			SDL_DestroyTexture(m_MapTexture);
 
-	const Frame joints = m_Robot.GetJointFrames();
-	const Coord coord1 = RobotToWindowFrame(joints[0]);
-	const Coord coord2 = RobotToWindowFrame(joints[1]);
+		m_MapTexture = SDL_CreateTexture(
+			m_Renderer, SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_STREAMING, m_Width, m_Height
+		);
+
+		if (m_MapTexture == nullptr)
+			ThrowRuntime("Failed to create map texture.", SDL_GetError());
+	}
 
-	DrawCircle(coord1.x, coord1.y, r1);
-	DrawCircle(coord2.x, coord2.y, r2);
+	// Upload only the tiles finished since the last frame
+	const uint32_t* image = m_Explorer->GetImage();
+
+	for (const Explorer::Rect& r : m_Explorer->Update())
+	{
+		const SDL_Rect area{ r.x, r.y, r.w, r.h };
+		SDL_UpdateTexture(m_MapTexture, &area, image + (size_t)r.y * m_Width + r.x, m_Width * (int)sizeof(uint32_t));
+	}
+
+	SDL_RenderCopy(m_Renderer, m_MapTexture, NULL, NULL);
 }
 
 void Window::RenderInfo()
 {
+	PROFILE_SCOPE(prof::Phase::RenderInfo);
+
 	if (m_StepInfo)
 	{
-		constexpr auto c = cfg::col::WHITE;
-		constexpr SDL_Color fg{ c[0], c[1], c[2], SDL_ALPHA_OPAQUE };
+		const Snapshot& snapshot = m_Physics.GetSnapshot();
 
-		SDL_DestroyTexture(m_Texture);
-		SDL_DestroyTexture(m_TextureSim);
-		SDL_DestroyTexture(m_TextureInfo);
+		std::vector<std::string> lines
+		{
+			"Render time: " + std::to_string(m_DeltaTime * 1000.0).substr(0, 4) + "ms",
+			"Simulation time: " + std::to_string(snapshot.delta * 1000.0).substr(0, 4) + "ms",
+			"Info update time: " + std::to_string(m_DeltaTimeInfo * 1000.0).substr(0, 6) + "ms",
+			"Simulation ratio: " + std::to_string(snapshot.ratio).substr(0, 4) + "x",
+			"Frame jitter: " + std::to_string(m_Pacer.GetJitter() * 1000.0).substr(0, 4) + "ms (max " +
+				std::to_string(m_Pacer.GetMaxJitter() * 1000.0).substr(0, 4) + "ms)",
+			"Physics jitter: " + std::to_string(snapshot.jitter * 1000.0).substr(0, 4) + "ms (max " +
+				std::to_string(snapshot.max_jitter * 1000.0).substr(0, 4) + "ms)"
+		};
 
-		std::string text("Render time: ");
-		std::string text_sim("Simulation time: ");
-		std::string text_info("Info update time: ");
+		if (!snapshot.chain)
+		{
+			const Monitor& monitor = snapshot.robot.GetMonitor();
+			lines.push_back("Energy: " + Format(monitor.GetEnergy().total) + "J");
+			lines.push_back("Friction work: " + Format(monitor.GetDissipated()) + "J");
+			lines.push_back("Energy drift: " + Format(monitor.GetDrift()) + "J (max " + Format(monitor.GetMaxError()) + "J)");
+		}
 
-		text += std::to_string(m_DeltaTime * 1000.0).substr(0, 4) + "ms";
-		text_sim += std::to_string(m_DeltaTimeSim * 1000.0).substr(0, 4) + "ms";
-		text_info += std::to_string(m_DeltaTimeInfo * 1000.0).substr(0, 6) + "ms";
+		if (m_Explore)
+			lines.push_back("Map progress: " + std::to_string((int)(m_Explorer->GetProgress() * 100.0)) + "%");
 
-		SDL_Surface* surface = TTF_RenderText_Solid(m_Font, text.c_str(), fg);
-		SDL_Surface* surface_sim = TTF_RenderText_Solid(m_Font, text_sim.c_str(), fg);
-		SDL_Surface* surface_info = TTF_RenderText_Solid(m_Font, text_info.c_str(), fg);
+#if PENDULUM_PROFILE
+		if (m_Profile)
+		{
+			lines.push_back("Phase p50/p95/p99/max (ms)");
 
-		m_Texture = SDL_CreateTextureFromSurface(m_Renderer, surface);
-		m_TextureSim = SDL_CreateTextureFromSurface(m_Renderer, surface_sim);
-		m_TextureInfo = SDL_CreateTextureFromSurface(m_Renderer, surface_info);
+			for (int p = 0; p < (int)prof::Phase::Count; p++)
+			{
+				const prof::Stats stats = prof::Summarise((prof::Phase)p);
 
-		m_TextureArea = {
-			0, 0,
-			surface->w, surface->h
-		};
-		m_TextureAreaSim = {
-			0, surface->h,
-			surface_sim->w, surface_sim->h
-		};
-		m_TextureAreaInfo = {
-			0, surface->h + surface_sim->h,
-			surface_info->w, surface_info->h
-		};
+				if (stats.count > 0)
+					lines.push_back(std::string(prof::GetName((prof::Phase)p)) + ": " + Format(stats.p50) + " / " +
+						Format(stats.p95) + " / " + Format(stats.p99) + " / " + Format(stats.max));
+			}
+		}
+#endif
 
-		SDL_FreeSurface(surface);
-		SDL_FreeSurface(surface_sim);
-		SDL_FreeSurface(surface_info);
+		{
+			PROFILE_SCOPE(prof::Phase::DrawText);
+			DrawText(m_Renderer, m_Font, lines, m_Textures, m_TextureAreas);
+		}
 
 		m_StepInfo = false;
 	}
-	
-	SDL_RenderCopy(m_Renderer, m_Texture, NULL, &m_TextureArea);
-	SDL_RenderCopy(m_Renderer, m_TextureSim, NULL, &m_TextureAreaSim);
-	SDL_RenderCopy(m_Renderer, m_TextureInfo, NULL, &m_TextureAreaInfo);
+
+	for (size_t i = 0; i < m_Textures.size(); i++)
+		SDL_RenderCopy(m_Renderer, m_Textures[i], NULL, &m_TextureAreas[i]);
 }
 
 void Window::HandleEvents()
 {
+	PROFILE_SCOPE(prof::Phase::HandleEvents);
+
 	SDL_Event event;
 
-	while (SDL_PollEvent(&event))
+	// Block on input while paused and nothing new has been published, the map keeps drawing
+	m_Idle = !m_Explore && !m_Fresh && m_Physics.GetSnapshot().paused;
+	const int timeout = (int)(cfg::win::INFO_TIME * 1000.0);
+	bool waiting = m_Idle;
+
+	while (waiting ? SDL_WaitEventTimeout(&event, timeout) : SDL_PollEvent(&event))
 	{
+		waiting = false;
+
+		if (m_Explore)
+			HandleMapEvent(event);
+
 		switch (event.type)
 		{
 		case SDL_KEYDOWN:
@@ -321,15 +319,30 @@ void Window::HandleEvents()
 				m_Quit = true;
 				break;
 			case SDLK_s:
-				m_OneStep = true;
+				m_Physics.Send(Command::Step);
 				break;
 			case SDLK_SPACE:
-				m_Pause = !m_Pause;
+				m_Physics.Send(Command::Pause);
 				break;
 			case SDLK_r:
 			case SDLK_0:
-				m_Robot.Restart();
+				m_Physics.Send(Command::Restart);
+				break;
+			case SDLK_c:
+				m_Physics.Send(Command::Model);
+				break;
+			case SDLK_f:
+				if (!m_Explorer)
+					m_Explorer = std::make_unique<Explorer>();
+
+				m_Explore = !m_Explore;
+				m_Pressed = false;
+				break;
+#if PENDULUM_PROFILE
+			case SDLK_p:
+				m_Profile = !m_Profile;
 				break;
+#endif
 			}
 			break;
 		case SDL_QUIT:
@@ -339,9 +352,59 @@ void Window::HandleEvents()
 	}
 }
 
+void Window::HandleMapEvent(const SDL_Event& event)
+{
+	switch (event.type)
+	{
+	case SDL_MOUSEWHEEL:
+	{
+		int x, y;
+		SDL_GetMouseState(&x, &y);
+		m_Explorer->Zoom(pow(cfg::explore::ZOOM, event.wheel.y), x, y);
+		break;
+	}
+	case SDL_MOUSEBUTTONDOWN:
+		if (event.button.button == SDL_BUTTON_LEFT)
+		{
+			m_Pressed = true;
+			m_Dragged = false;
+			m_Press = SDL_Point{ event.button.x, event.button.y };
+			m_Mouse = m_Press;
+		}
+		break;
+	case SDL_MOUSEMOTION:
+		if (m_Pressed)
+		{
+			const int x = event.motion.x;
+			const int y = event.motion.y;
+
+			m_Dragged = m_Dragged
+				|| abs(x - m_Press.x) > cfg::explore::CLICK_SLOP
+				|| abs(y - m_Press.y) > cfg::explore::CLICK_SLOP;
+
+			if (m_Dragged)
+			{
+				m_Explorer->Pan(x - m_Mouse.x, y - m_Mouse.y);
+				m_Mouse = SDL_Point{ x, y };
+			}
+		}
+		break;
+	case SDL_MOUSEBUTTONUP:
+		// A click rather than a drag launches that pendulum in the normal view
+		if (event.button.button == SDL_BUTTON_LEFT && m_Pressed && !m_Dragged)
+		{
+			m_Physics.Launch(m_Explorer->GetState(event.button.x, event.button.y));
+			m_Explore = false;
+		}
+
+		m_Pressed = false;
+		break;
+	}
+}
+
 void Window::SetColour(const int rgb[3])
 {
-	SDL_SetRenderDrawColor(m_Renderer, rgb[0], rgb[1], rgb[2], SDL_ALPHA_OPAQUE);
+	SetDrawColour(m_Renderer, rgb);
 }
 
 Coord Window::RobotToWindowFrame(const Coord& coord)
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "Font.hpp"
-#include "Robot.hpp"
-#include "Config.hpp"
+#include "robot.hpp"
+#include "physics.hpp"
+#include "explorer.hpp"
+#include "config.hpp"
+#include "pacer.hpp"
+#include "profile.hpp"
 
 #include <SDL.h>
 #include <SDL_ttf.h>
@@ -33,8 +37,10 @@ private:
 	void RenderBackground();
 	void RenderLinks();
 	void RenderJoints();
+	void RenderMap();
 	void RenderInfo();
 	void HandleEvents();
+	void HandleMapEvent(const SDL_Event& event);
 	void SetColour(const int rgb[3]);
 	Coord RobotToWindowFrame(const Coord& coord);
 
@@ -43,25 +49,31 @@ private:
 	double m_CentreX;
 	double m_CentreY;
 	double m_DeltaTime;
-	double m_DeltaTimeSim;
 	double m_DeltaTimeInfo;
 	Time m_Time;
-	Time m_TimeSim;
 	Time m_TimeInfo;
-	bool m_StepSim;
 	bool m_StepInfo;
-	bool m_OneStep;
+	bool m_Fresh;
+	// The last HandleEvents blocked on input
+	bool m_Idle;
+	bool m_VSync;
 	bool m_Quit;
-	bool m_Pause;
-	Robot m_Robot;
+	bool m_Explore;
+#if PENDULUM_PROFILE
+	bool m_Profile;
+#endif
+	bool m_Pressed;
+	bool m_Dragged;
+	SDL_Point m_Press;
+	SDL_Point m_Mouse;
+	Physics m_Physics;
+	Pacer m_Pacer;
+	std::unique_ptr<Explorer> m_Explorer;
 
 	TTF_Font* m_Font;
 	SDL_Window* m_Window;
 	SDL_Renderer* m_Renderer;
-	SDL_Texture* m_Texture;
-	SDL_Texture* m_TextureSim;
-	SDL_Texture* m_TextureInfo;
-	SDL_Rect m_TextureArea;
-	SDL_Rect m_TextureAreaSim;
-	SDL_Rect m_TextureAreaInfo;
+	SDL_Texture* m_MapTexture;
+	std::vector<SDL_Texture*> m_Textures;
+	std::vector<SDL_Rect> m_TextureAreas;
 };
@@ -0,0 +1,309 @@
+#include "harness.hpp"
+
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+	// JSON string contents, escaping quotes, backslashes and control characters
+	std::string Escape(const std::string& text)
+	{
+		std::string escaped;
+
+		for (const char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				escaped += '\\';
+				escaped += c;
+			}
+			else if ((unsigned char)c < 0x20)
+			{
+				char code[8];
+				std::snprintf(code, sizeof(code), "\\u%04x", (unsigned)c);
+				escaped += code;
+			}
+			else
+				escaped += c;
+		}
+
+		return escaped;
+	}
+
+	// Back from Escape, other escapes keep their character
+	std::string Unescape(const std::string& text)
+	{
+		std::string plain;
+
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			if (text[i] != '\\' || i + 1 == text.size())
+				plain += text[i];
+			else if (text[i + 1] == 'u' && i + 5 < text.size()
+				&& std::all_of(text.begin() + i + 2, text.begin() + i + 6, [](const unsigned char c) { return std::isxdigit(c); }))
+			{
+				plain += char(std::strtol(text.substr(i + 2, 4).c_str(), nullptr, 16));
+				i += 5;
+			}
+			else
+				plain += text[++i];
+		}
+
+		return plain;
+	}
+}
+
+Harness::Harness(const int count, const double sample, const double warmup)
+	: m_Count{ count }, m_Sample{ sample }, m_Warmup{ warmup }, m_Tags{}, m_Results{}
+{
+	if (count < 1)
+		throw std::invalid_argument("A benchmark needs at least one sample.");
+}
+
+void Harness::Tag(const std::string& key, const std::string& value)
+{
+	m_Tags.emplace_back(key, value);
+}
+
+const std::vector<std::pair<std::string, std::string>>& Harness::GetTags() const
+{
+	return m_Tags;
+}
+
+const std::vector<Measurement>& Harness::GetResults() const
+{
+	return m_Results;
+}
+
+void Harness::WriteJson(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	file.precision(17);
+	file << "{\n  \"context\": {";
+
+	for (size_t i = 0; i < m_Tags.size(); i++)
+		file << (i == 0 ? "\n" : ",\n") << "    \"" << Escape(m_Tags[i].first) << "\": \"" << Escape(m_Tags[i].second) << "\"";
+
+	file << "\n  },\n  \"benchmarks\": [\n";
+
+	for (size_t i = 0; i < m_Results.size(); i++)
+	{
+		const Measurement& m = m_Results[i];
+		file << "    {\n";
+		file << "      \"name\": \"" << Escape(m.name) << "\",\n";
+		file << "      \"iterations\": " << m.iterations << ",\n";
+		file << "      \"median_ns\": " << m.median << ",\n";
+		file << "      \"mad_ns\": " << m.mad << ",\n";
+		file << "      \"samples_ns\": [";
+
+		for (size_t j = 0; j < m.samples.size(); j++)
+			file << (j == 0 ? "" : ", ") << m.samples[j];
+
+		file << "]\n    }" << (i + 1 < m_Results.size() ? "," : "") << "\n";
+	}
+
+	file << "  ]\n}\n";
+
+	if (!file)
+		throw std::runtime_error("Failed to write '" + path + "'.");
+}
+
+// Reads back the layout WriteJson produces, not JSON in general
+Report Harness::ReadJson(const std::string& path)
+{
+	std::ifstream file(path);
+
+	if (!file)
+		throw std::runtime_error("Failed to open '" + path + "'.");
+
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	const std::string text = buffer.str();
+
+	const size_t context = text.find("\"context\"");
+	const size_t benchmarks = text.find("\"benchmarks\"");
+
+	if (benchmarks == std::string::npos)
+		throw std::runtime_error("No benchmarks in '" + path + "'.");
+
+	Report report;
+	// Strings may hold escaped quotes and backslashes
+	const std::regex pair("\"(\\w+)\"\\s*:\\s*\"((?:[^\"\\\\]|\\\\.)*)\"");
+	const std::regex object("\\{[^{}]*\\}");
+	const std::regex name("\"name\"\\s*:\\s*\"((?:[^\"\\\\]|\\\\.)*)\"");
+	const std::regex iterations("\"iterations\"\\s*:\\s*(\\d+)");
+	const std::regex samples("\"samples_ns\"\\s*:\\s*\\[([^\\]]*)\\]");
+
+	if (context != std::string::npos && context < benchmarks)
+	{
+		const std::string tags = text.substr(context + 9, benchmarks - context - 9);
+
+		for (std::sregex_iterator it(tags.begin(), tags.end(), pair), end; it != end; ++it)
+			report.tags.emplace_back((*it)[1], Unescape((*it)[2]));
+	}
+
+	const std::string list = text.substr(benchmarks);
+
+	for (std::sregex_iterator it(list.begin(), list.end(), object), end; it != end; ++it)
+	{
+		const std::string body = it->str();
+		std::smatch match;
+		Measurement m{ "", 0, {}, 0.0, 0.0 };
+
+		if (!std::regex_search(body, match, name))
+			throw std::runtime_error("A benchmark in '" + path + "' has no name.");
+
+		m.name = Unescape(match[1]);
+
+		// std::stoll and std::stod throw logic errors, a bad file is a runtime one
+		try
+		{
+			if (std::regex_search(body, match, iterations))
+				m.iterations = std::stoll(match[1]);
+
+			if (std::regex_search(body, match, samples))
+			{
+				std::stringstream values(match[1].str());
+				std::string value;
+
+				while (std::getline(values, value, ','))
+					m.samples.push_back(std::stod(value));
+			}
+		}
+		catch (const std::logic_error&)
+		{
+			throw std::runtime_error("Benchmark '" + m.name + "' in '" + path + "' has a malformed number.");
+		}
+
+		Summarise(m);
+		report.results.push_back(m);
+	}
+
+	return report;
+}
+
+int Harness::Compare(const Report& baseline, const double threshold, const double alpha) const
+{
+	int slower = 0;
+
+	std::printf("Against baseline (slower when over %.1f%% with p < %g)\n", 100.0 * threshold, alpha);
+	std::printf("  %-24s %12s %12s %9s %10s\n", "", "baseline", "current", "change", "p");
+
+	for (const Measurement& m : m_Results)
+	{
+		const auto it = std::find_if(baseline.results.begin(), baseline.results.end(),
+			[&](const Measurement& b) { return b.name == m.name; });
+
+		if (it == baseline.results.end() || it->samples.empty())
+		{
+			std::printf("  %-24s %12s %10.2fns   no baseline\n", m.name.c_str(), "", m.median);
+			continue;
+		}
+
+		const double change = m.median / it->median - 1.0;
+		const double p = MannWhitney(it->samples, m.samples);
+		const bool regressed = change > threshold && p < alpha;
+		// Same test the other way round for the good news
+		const bool improved = change < -threshold && MannWhitney(m.samples, it->samples) < alpha;
+
+		std::printf("  %-24s %10.2fns %10.2fns %+8.2f%% %10.2e %s\n", m.name.c_str(), it->median, m.median,
+			100.0 * change, p, regressed ? "SLOWER" : improved ? "faster" : "");
+
+		slower += regressed;
+	}
+
+	return slower;
+}
+
+double Harness::Median(std::vector<double> values)
+{
+	if (values.empty())
+		return NAN;
+
+	const size_t half = values.size() / 2;
+	std::nth_element(values.begin(), values.begin() + half, values.end());
+	const double upper = values[half];
+
+	if (values.size() % 2 == 1)
+		return upper;
+
+	return 0.5 * (upper + *std::max_element(values.begin(), values.begin() + half));
+}
+
+double Harness::MannWhitney(const std::vector<double>& a, const std::vector<double>& b)
+{
+	const size_t na = a.size();
+	const size_t nb = b.size();
+	const size_t n = na + nb;
+
+	if (na == 0 || nb == 0)
+		return 1.0;
+
+	// Pooled samples tagged by origin, ranked with ties sharing their mean rank
+	std::vector<std::pair<double, bool>> pooled;
+
+	for (const double x : a)
+		pooled.emplace_back(x, false);
+	for (const double x : b)
+		pooled.emplace_back(x, true);
+
+	std::sort(pooled.begin(), pooled.end());
+
+	double rank_b = 0.0;
+	double ties = 0.0;
+
+	for (size_t i = 0; i < n;)
+	{
+		size_t j = i;
+
+		while (j < n && pooled[j].first == pooled[i].first)
+			j++;
+
+		const double rank = 0.5 * (i + 1 + j);
+		const double t = double(j - i);
+		ties += t * t * t - t;
+
+		for (size_t k = i; k < j; k++)
+			if (pooled[k].second)
+				rank_b += rank;
+
+		i = j;
+	}
+
+	const double u = rank_b - 0.5 * nb * (nb + 1);
+	const double mean = 0.5 * na * nb;
+	const double variance = na * nb / 12.0 * ((n + 1) - ties / (double(n) * (n - 1)));
+
+	if (variance <= 0.0)
+		return 1.0;
+
+	// Continuity corrected, large U means b ranks above a
+	const double z = (u - mean - 0.5) / std::sqrt(variance);
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+void Harness::Summarise(Measurement& m)
+{
+	m.median = Median(m.samples);
+
+	std::vector<double> deviations;
+
+	for (const double s : m.samples)
+		deviations.push_back(std::fabs(s - m.median));
+
+	m.mad = Median(deviations);
+}
+
+void Harness::Print(const Measurement& m)
+{
+	std::printf("  %-24s %10.2fns +- %8.2fns %6.2f%% (%zu x %lld)\n",
+		m.name.c_str(), m.median, m.mad, 100.0 * m.mad / m.median, m.samples.size(), m.iterations);
+}
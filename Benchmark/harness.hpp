@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+
+
+// Timing of one benchmark in nanoseconds per call
+struct Measurement
+{
+	std::string name;
+	// Calls per sample
+	long long iterations;
+	std::vector<double> samples;
+	double median;
+	// Median absolute deviation from the median
+	double mad;
+};
+
+// Results as stored, with tags describing the machine they were measured on
+struct Report
+{
+	std::vector<std::pair<std::string, std::string>> tags;
+	std::vector<Measurement> results;
+};
+
+// Volatile, so every write to it happens
+inline volatile double g_Sink;
+
+// Keep a result observable so the call producing it is not optimised away
+inline void Keep(const double value)
+{
+	g_Sink = value;
+}
+
+// Repeatable microbenchmarks. Each is warmed up for at least warmup seconds
+// while the calls per sample double until a sample takes sample seconds, then
+// timed for count samples and summarised by the median and its absolute
+// deviation, which shrug off the odd preempted sample a mean would not.
+class Harness
+{
+public:
+	Harness(const int count = 31, const double sample = 2e-3, const double warmup = 0.1);
+
+	template <class F>
+	const Measurement& Run(const std::string& name, F&& f)
+	{
+		long long iterations = 1;
+		const auto begin = Clock::now();
+
+		while (true)
+		{
+			const double seconds = Sample(f, iterations);
+			const double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+
+			if (seconds < m_Sample)
+				iterations *= 2;
+			else if (elapsed >= m_Warmup)
+				break;
+		}
+
+		Measurement m{ name, iterations, {}, 0.0, 0.0 };
+
+		for (int i = 0; i < m_Count; i++)
+			m.samples.push_back(Sample(f, iterations) * 1e9 / iterations);
+
+		Summarise(m);
+		Print(m);
+		m_Results.push_back(m);
+		return m_Results.back();
+	}
+
+	// Describe the machine, e.g. its CPU and ISA level, written alongside the results
+	void Tag(const std::string& key, const std::string& value);
+	const std::vector<std::pair<std::string, std::string>>& GetTags() const;
+	const std::vector<Measurement>& GetResults() const;
+	void WriteJson(const std::string& path) const;
+	static Report ReadJson(const std::string& path);
+
+	// Print each benchmark against the baseline and return how many slowed down by more
+	// than threshold, as a fraction of the baseline median, with one-sided p below alpha
+	int Compare(const Report& baseline, const double threshold, const double alpha) const;
+
+	static double Median(std::vector<double> values);
+	// One-sided Mann-Whitney U test by the normal approximation with tie correction,
+	// the p value of samples b being no slower than samples a
+	static double MannWhitney(const std::vector<double>& a, const std::vector<double>& b);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	template <class F>
+	static double Sample(F& f, const long long iterations)
+	{
+		const auto start = Clock::now();
+
+		for (long long i = 0; i < iterations; i++)
+			f();
+
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	static void Summarise(Measurement& m);
+	static void Print(const Measurement& m);
+
+	int m_Count;
+	double m_Sample;
+	double m_Warmup;
+	std::vector<std::pair<std::string, std::string>> m_Tags;
+	std::vector<Measurement> m_Results;
+};
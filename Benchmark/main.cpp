@@ -0,0 +1,652 @@
+// SDL must not rename main
+#define SDL_MAIN_HANDLED
+
+#include "draw.hpp"
+#include "Font.hpp"
+#include "pool.hpp"
+#include "robot.hpp"
+#include "fixed.hpp"
+#include "kernel.hpp"
+#include "ensemble.hpp"
+#include "lyapunov.hpp"
+#include "dynamics.hpp"
+#include "harness.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <exception>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+
+// Closed-form expressions Robot::Update used before the manipulator-form kernel
+static Vector LegacyDerivative(const Vector& x)
+{
+	double trq1, trq2;
+	double a1, a2;
+
+	const double q1 = x[0];
+	const double q2 = x[1];
+	const double w1 = x[2];
+	const double w2 = x[3];
+	constexpr double g = cfg::env::GRAVITY;
+	constexpr double m1 = cfg::link::MASS[0];
+	constexpr double m2 = cfg::link::MASS[1];
+	constexpr double L1 = cfg::link::LENGTH[0];
+	constexpr double L2 = cfg::link::LENGTH[1];
+	constexpr double u1 = cfg::joint::FRICTION[0];
+	constexpr double u2 = cfg::joint::FRICTION[1];
+
+	trq1 = -u1 * w1;
+	trq2 = -u2 * w2;
+
+	const double cosq1 = cos(q1);
+	const double cosq2 = cos(q2);
+	const double sinq2 = sin(q2);
+	const double cosq12 = cos(q1 + q2);
+	a1 = (trq1 - L1 * g * cosq1 * (m1 + m2) - L2 * g * m2 * cosq12 + L1 * L2 * m2 * w2 * sinq2 * (2 * w1 + w2)) / (L1 * L1 * (-m2 * cosq2 * cosq2 + m1 + m2)) + ((L2 + L1 * cosq2) * (L1 * L2 * m2 * sinq2 * w1 * w1 - trq2 + L2 * g * m2 * cosq12)) / (L1 * L1 * L2 * (-m2 * cosq2 * cosq2 + m1 + m2));
+	a2 = -((L2 + L1 * cosq2) * (trq1 - L1 * g * cosq1 * (m1 + m2) - L2 * g * m2 * cosq12 + L1 * L2 * m2 * w2 * sinq2 * (2 * w1 + w2))) / (L1 * L1 * L2 * (-m2 * cosq2 * cosq2 + m1 + m2)) - ((L1 * L2 * m2 * sinq2 * w1 * w1 - trq2 + L2 * g * m2 * cosq12) * (L1 * L1 * m1 + L1 * L1 * m2 + L2 * L2 * m2 + 2 * L1 * L2 * m2 * cosq2)) / (L1 * L1 * L2 * L2 * m2 * (-m2 * cosq2 * cosq2 + m1 + m2));
+
+	return Vector{ w1, w2, a1, a2 };
+}
+
+// Distance in units in the last place between two doubles
+static uint64_t Ulps(const double a, const double b)
+{
+	int64_t ia, ib;
+	std::memcpy(&ia, &a, sizeof(a));
+	std::memcpy(&ib, &b, sizeof(b));
+
+	if (ia < 0)
+		ia = INT64_MIN - ia;
+	if (ib < 0)
+		ib = INT64_MIN - ib;
+
+	return ia > ib ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia;
+}
+
+// Best-of-repetitions nanoseconds per call of f over every state
+template <class F>
+static double Time(F&& f, const std::vector<Vector>& states, const int reps)
+{
+	double best = INFINITY;
+	double sink = 0.0;
+
+	for (int r = 0; r < reps; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		for (const Vector& x : states)
+			sink += f(x)[3];
+
+		auto stop = std::chrono::steady_clock::now();
+		double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+		best = std::min(best, ns / states.size());
+	}
+
+	// Keep the results observable so nothing is optimised away
+	if (sink == 0.123456789)
+		std::printf(" ");
+
+	return best;
+}
+
+static void BenchmarkKernel()
+{
+	constexpr int N = 1 << 16;
+	constexpr int REPS = 21;
+	constexpr double h = 1.0 / cfg::sim::RATE;
+	constexpr double PI = 3.14159265358979323846;
+
+	std::mt19937_64 rng(42);
+	std::uniform_real_distribution<double> angle(-PI, PI);
+	std::uniform_real_distribution<double> speed(-20.0, 20.0);
+	std::vector<Vector> states(N);
+
+	for (Vector& x : states)
+		x = Vector{ angle(rng), angle(rng), speed(rng), speed(rng) };
+
+	auto legacy = [](const Vector& x) { return LegacyDerivative(x); };
+	auto kernel = [](const Vector& x) { return Robot::Derivative(x); };
+	auto legacy_rk4 = [&](const Vector& x) { Vector dx; return integrator::RK4::Step(legacy, x, h, dx); };
+	auto kernel_rk4 = [&](const Vector& x) { Vector dx; return integrator::RK4::Step(kernel, x, h, dx); };
+
+	std::printf("Dynamics kernel (%d states, best of %d)\n", N, REPS);
+	std::printf("  %-24s %10s %10s\n", "", "legacy", "kernel");
+	std::printf("  %-24s %8.2fns %8.2fns\n", "derivative", Time(legacy, states, REPS), Time(kernel, states, REPS));
+	std::printf("  %-24s %8.2fns %8.2fns\n", "RK4 step", Time(legacy_rk4, states, REPS), Time(kernel_rk4, states, REPS));
+
+	// Accuracy of the restructured kernel against the legacy expressions
+	uint64_t max_ulps = 0;
+	double max_abs = 0.0;
+	double max_rel = 0.0;
+	int identical = 0;
+	int histogram[5] = {};
+
+	for (const Vector& x : states)
+	{
+		const Vector a = LegacyDerivative(x);
+		const Vector b = Robot::Derivative(x);
+
+		for (int n = 2; n < 4; n++)
+		{
+			const uint64_t ulps = Ulps(a[n], b[n]);
+			const double abs = std::fabs(a[n] - b[n]);
+
+			max_ulps = std::max(max_ulps, ulps);
+			max_abs = std::max(max_abs, abs);
+			max_rel = std::max(max_rel, abs / std::max(std::fabs(a[n]), 1e-300));
+			identical += ulps == 0;
+			histogram[ulps == 0 ? 0 : ulps <= 4 ? 1 : ulps <= 64 ? 2 : ulps <= 4096 ? 3 : 4]++;
+		}
+	}
+
+	std::printf("Accuracy against legacy (%d accelerations)\n", 2 * N);
+	std::printf("  bit identical   %d\n", identical);
+	std::printf("  1-4 ulp         %d\n", histogram[1]);
+	std::printf("  5-64 ulp        %d\n", histogram[2]);
+	std::printf("  65-4096 ulp     %d\n", histogram[3]);
+	std::printf("  >4096 ulp       %d\n", histogram[4]);
+	std::printf("  max ulp         %llu\n", (unsigned long long)max_ulps);
+	std::printf("  max abs error   %.3e\n", max_abs);
+	std::printf("  max rel error   %.3e\n", max_rel);
+}
+
+// Rope of N equal links with the same total mass and length as the pendulum
+template <size_t N>
+struct Rope
+{
+	static constexpr double Mass(const size_t) { return 2.0 / N; }
+	static constexpr double Length(const size_t) { return 0.2 / N; }
+	static constexpr double Friction(const size_t) { return 0.05; }
+};
+
+// Best-of-repetitions nanoseconds per Update of a model released from rest
+template <class Model>
+static double TimeSteps(Model& model, const int steps, const int reps)
+{
+	constexpr double h = 1.0 / cfg::sim::RATE;
+	double best = INFINITY;
+
+	for (int r = 0; r < reps; r++)
+	{
+		model.Restart();
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < steps; i++)
+			model.Update(h);
+
+		auto stop = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count() / steps);
+	}
+
+	return best;
+}
+
+template <size_t N>
+static void BenchmarkChain(const int steps, const int reps)
+{
+	using Params = Rope<N>;
+	FixedChain<N, Params> fixed;
+	Chain chain = Chain::Rope((int)N, 2.0, 0.2, 0.05);
+
+	const double a = TimeSteps(fixed, steps, reps);
+	const double b = TimeSteps(chain, steps, reps);
+	std::printf("  %-24zu %8.2fns %8.2fns %9.2fx\n", N, a, b, b / a);
+}
+
+static void BenchmarkChains()
+{
+	constexpr int STEPS = 1 << 16;
+	constexpr int REPS = 11;
+
+	FixedChain<2, params::Pendulum> fixed;
+	Robot robot(Method::RK4);
+
+	std::printf("Chain RK4 step (%d steps, best of %d)\n", STEPS, REPS);
+	std::printf("  %-24s %10s %10s\n", "", "robot", "fixed");
+	std::printf("  %-24s %8.2fns %8.2fns\n", "double pendulum", TimeSteps(robot, STEPS, REPS), TimeSteps(fixed, STEPS, REPS));
+	std::printf("  %-24s %10s %10s %10s\n", "links", "fixed", "runtime", "speedup");
+
+	BenchmarkChain<2>(STEPS, REPS);
+	BenchmarkChain<3>(STEPS, REPS);
+	BenchmarkChain<5>(STEPS, REPS);
+	BenchmarkChain<8>(STEPS, REPS);
+}
+
+// Largest absolute error of the vectorised sincos against the C library
+template <class P>
+static double SinCosError(const int n)
+{
+	using Scalar = typename P::Scalar;
+	alignas(simd::ALIGNMENT) Scalar x[P::WIDTH];
+	alignas(simd::ALIGNMENT) Scalar s[P::WIDTH];
+	alignas(simd::ALIGNMENT) Scalar c[P::WIDTH];
+
+	std::mt19937_64 rng(7);
+	std::uniform_real_distribution<double> angle(-1e3, 1e3);
+	double error = 0.0;
+
+	for (int i = 0; i < n; i++)
+	{
+		for (size_t l = 0; l < P::WIDTH; l++)
+			x[l] = Scalar(angle(rng));
+
+		P ps, pc;
+		simd::SinCos(P::Load(x), ps, pc);
+		ps.Store(s);
+		pc.Store(c);
+
+		for (size_t l = 0; l < P::WIDTH; l++)
+		{
+			error = std::max(error, std::fabs(s[l] - std::sin(double(x[l]))));
+			error = std::max(error, std::fabs(c[l] - std::cos(double(x[l]))));
+		}
+	}
+
+	return error;
+}
+
+// Millions of pendulum steps per second for a batch released from random states
+template <class Real>
+static double TimeEnsemble(const size_t size, const int steps, const int reps)
+{
+	constexpr double h = 1.0 / cfg::sim::RATE;
+	constexpr double PI = 3.14159265358979323846;
+
+	std::mt19937_64 rng(42);
+	std::uniform_real_distribution<double> angle(-PI, PI);
+	Ensemble<Real> ensemble(size);
+	double best = INFINITY;
+
+	for (size_t i = 0; i < size; i++)
+		ensemble.Set(i, Vector{ angle(rng), angle(rng), 0.0, 0.0 });
+
+	for (int r = 0; r < reps; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		ensemble.Update(h, steps);
+		auto stop = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double>(stop - start).count());
+	}
+
+	return size * steps / best * 1e-6;
+}
+
+// Pendulum steps per second with the four tangent vectors, in millions
+static double TimeLyapunov(const size_t size, const int steps, const int reps)
+{
+	constexpr double h = 1.0 / cfg::sim::RATE;
+	constexpr double PI = 3.14159265358979323846;
+
+	std::mt19937_64 rng(42);
+	std::uniform_real_distribution<double> angle(-PI, PI);
+	Lyapunov lyapunov(size);
+	double best = INFINITY;
+
+	for (size_t i = 0; i < size; i++)
+		lyapunov.Set(i, Vector{ angle(rng), angle(rng), 0.0, 0.0 });
+
+	for (int r = 0; r < reps; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		lyapunov.Update(h, steps);
+		auto stop = std::chrono::steady_clock::now();
+		best = std::min(best, std::chrono::duration<double>(stop - start).count());
+	}
+
+	return size * steps / best * 1e-6;
+}
+
+static void BenchmarkEnsemble()
+{
+	constexpr size_t SIZE = 1 << 14;
+	constexpr int STEPS = 100;
+	constexpr int REPS = 5;
+
+	const kernels::Level active = kernels::Get().level;
+	const kernels::Level best = kernels::Detect();
+
+	std::printf("Ensemble RK4 (%zu pendulums x %d steps, best of %d, one core, %s selected)\n",
+		SIZE, STEPS, REPS, kernels::GetName(active));
+	std::printf("  %-24s %10s %10s %10s %10s %10s\n", "", "f64 lanes", "Msteps/s", "f32 lanes", "Msteps/s", "Lyapunov");
+
+	// Every level this CPU can run, forced in turn
+	for (int i = 0; i <= (int)best; i++)
+	{
+		const kernels::Level level = (kernels::Level)i;
+		kernels::Force(level);
+
+		const kernels::Table& table = kernels::Get();
+		const double f64 = TimeEnsemble<double>(SIZE, STEPS, REPS);
+		const double f32 = TimeEnsemble<float>(SIZE, STEPS, REPS);
+		const double tangent = TimeLyapunov(SIZE, STEPS, REPS);
+		std::printf("  %-24s %10zu %10.2f %10zu %10.2f %10.2f\n", kernels::GetName(level), table.width_f64, f64, table.width_f32, f32, tangent);
+	}
+
+	kernels::Force(active);
+
+	std::printf("Vectorised sincos over |x| < 1e3\n");
+	std::printf("  %-24s %10.1e\n", "double max abs error", SinCosError<simd::F64>(1 << 16));
+	std::printf("  %-24s %10.1e\n", "float max abs error", SinCosError<simd::F32>(1 << 16));
+}
+
+// Ensemble throughput as the pool grows, with the spread of per-thread utilisation
+static void BenchmarkScaling()
+{
+	constexpr size_t SIZE = 1 << 20;
+	constexpr int STEPS = 20;
+	constexpr int REPS = 3;
+	constexpr double h = 1.0 / cfg::sim::RATE;
+	constexpr double PI = 3.14159265358979323846;
+
+	std::mt19937_64 rng(42);
+	std::uniform_real_distribution<double> angle(-PI, PI);
+	Ensemble<double> ensemble(SIZE);
+
+	for (size_t i = 0; i < SIZE; i++)
+		ensemble.Set(i, Vector{ angle(rng), angle(rng), 0.0, 0.0 });
+
+	const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+	double single = 0.0;
+
+	std::printf("Pool scaling (%zu pendulums x %d steps, %s, best of %d)\n", SIZE, STEPS, kernels::GetName(kernels::Get().level), REPS);
+	std::printf("  %-24s %10s %10s %10s %10s %10s\n", "threads", "Msteps/s", "speedup", "efficiency", "min util", "max util");
+
+	for (size_t threads = 1; ; threads = std::min(2 * threads, cores))
+	{
+		Pool pool(threads);
+		double best = INFINITY;
+
+		for (int r = 0; r < REPS; r++)
+		{
+			pool.ResetStats();
+			auto start = std::chrono::steady_clock::now();
+			ensemble.Update(h, STEPS, pool);
+			auto stop = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double>(stop - start).count());
+		}
+
+		double low = 1.0;
+		double high = 0.0;
+
+		for (size_t i = 0; i < threads; i++)
+		{
+			low = std::min(low, pool.GetUtilisation(i));
+			high = std::max(high, pool.GetUtilisation(i));
+		}
+
+		const double rate = SIZE * STEPS / best * 1e-6;
+		single = threads == 1 ? rate : single;
+		std::printf("  %-24zu %10.2f %9.2fx %9.0f%% %9.0f%% %9.0f%%\n",
+			threads, rate, rate / single, 100.0 * rate / single / threads, 100.0 * low, 100.0 * high);
+
+		if (threads == cores)
+			break;
+	}
+}
+
+// Per-call cost of what every frame runs, physics and drawing, with statistics fit
+// for comparing runs
+static void BenchmarkHotPaths(Harness& harness)
+{
+	constexpr double h = 1.0 / cfg::sim::RATE;
+	const Vector start{ 0.5, 1.0, 0.0, 0.0 };
+
+	std::printf("Hot paths (median and MAD per call)\n");
+
+	const std::pair<const char*, Method> methods[] =
+	{
+		{ "robot_update_rk4", Method::RK4 },
+		{ "robot_update_dopri45", Method::DOPRI45 },
+		{ "robot_update_yoshida4", Method::Yoshida4 },
+		{ "robot_update_sdirk2", Method::SDIRK2 }
+	};
+
+	// The adaptive and implicit costs vary along the swing, so every sample replays
+	// whole copies of its first CYCLE steps
+	constexpr long long CYCLE = 1024;
+
+	for (const auto& [name, method] : methods)
+	{
+		Robot robot(method);
+		long long calls = 0;
+
+		harness.Run(name, [&]
+		{
+			if (calls++ % CYCLE == 0)
+				robot.SetState(start);
+
+			robot.Update(h);
+		});
+		Keep(robot.GetPositions()[0]);
+	}
+
+	Robot robot;
+	robot.SetState(start);
+
+	harness.Run("robot_link_frames", [&]
+	{
+		const Frame f = robot.GetLinkFrames();
+		Keep(f[0].x + f[0].y + f[1].x + f[1].y);
+	});
+	harness.Run("robot_joint_frames", [&]
+	{
+		const Frame f = robot.GetJointFrames();
+		Keep(f[0].x + f[0].y + f[1].x + f[1].y);
+	});
+
+	// Offscreen software renderer, which needs no video subsystem
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, cfg::win::DEFAULT_WIDTH, cfg::win::DEFAULT_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+
+	if (renderer == nullptr)
+	{
+		std::printf("  Skipping drawing, no software renderer: %s\n", SDL_GetError());
+		SDL_FreeSurface(surface);
+		return;
+	}
+
+	const double x = cfg::win::DEFAULT_WIDTH / 2.0;
+	const double y = cfg::win::DEFAULT_HEIGHT / 2.0;
+	double angle = 0.0;
+
+	harness.Run("draw_rectangle", [&]
+	{
+		DrawRectangle(renderer, x, y, cfg::link::LENGTH[0] * 1000.0, cfg::link::WIDTH[0] * 1000.0, angle);
+		angle += 0.01;
+	});
+	harness.Run("draw_circle", [&]
+	{
+		DrawCircle(renderer, x, y, cfg::joint::RADIUS[0] * 1000.0);
+	});
+
+	TTF_Font* font = nullptr;
+
+	if (TTF_Init() == 0)
+		font = TTF_OpenFontRW(SDL_RWFromConstMem(CaskaydiaCoveNerdFont_Regular_ttf, CaskaydiaCoveNerdFont_Regular_ttf_len), 1, cfg::win::FONT_SIZE);
+
+	if (font != nullptr)
+	{
+		// As many lines as the overlay shows, changing every call like its timings do
+		std::vector<std::string> lines(8);
+		std::vector<SDL_Texture*> textures;
+		std::vector<SDL_Rect> areas;
+		int frame = 0;
+
+		harness.Run("render_info_text", [&]
+		{
+			for (size_t i = 0; i < lines.size(); i++)
+				lines[i] = "Render time: " + std::to_string(frame + i * 0.001).substr(0, 6) + "ms";
+
+			DrawText(renderer, font, lines, textures, areas);
+			frame++;
+		});
+
+		for (SDL_Texture* texture : textures)
+			SDL_DestroyTexture(texture);
+
+		TTF_CloseFont(font);
+	}
+	else
+		std::printf("  Skipping text, no font: %s\n", TTF_GetError());
+
+	TTF_Quit();
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(surface);
+}
+
+// Processor brand string from CPUID, empty where the CPU does not report one
+static std::string CpuName()
+{
+	unsigned int regs[12] = {};
+
+	for (unsigned int i = 0; i < 3; i++)
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0x80000000);
+
+		if ((unsigned int)info[0] < 0x80000004)
+			return "";
+
+		__cpuid(info, int(0x80000002 + i));
+
+		for (int j = 0; j < 4; j++)
+			regs[4 * i + j] = (unsigned int)info[j];
+#else
+		if (!__get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]))
+			return "";
+#endif
+	}
+
+	std::string name(reinterpret_cast<const char*>(regs), sizeof(regs));
+	name = name.c_str();
+
+	const size_t first = name.find_first_not_of(' ');
+	const size_t last = name.find_last_not_of(' ');
+	return first == std::string::npos ? "" : name.substr(first, last - first + 1);
+}
+
+// Machine description saved with the results, so a baseline from elsewhere is noticed
+static void TagMachine(Harness& harness)
+{
+	std::string features;
+
+	if (SDL_HasSSE2())
+		features += "sse2 ";
+	if (SDL_HasAVX())
+		features += "avx ";
+	if (SDL_HasAVX2())
+		features += "avx2 ";
+	if (SDL_HasAVX512F())
+		features += "avx512f ";
+
+	harness.Tag("cpu", CpuName());
+	harness.Tag("cores", std::to_string(SDL_GetCPUCount()));
+	harness.Tag("features", features.empty() ? "" : features.substr(0, features.size() - 1));
+	harness.Tag("isa", kernels::GetName(kernels::Get().level));
+#ifdef NDEBUG
+	harness.Tag("build", "release");
+#else
+	harness.Tag("build", "debug");
+#endif
+}
+
+// "Benchmark [--hot] [--json path] [--compare baseline.json [--threshold 0.03] [--alpha 0.01]]",
+// --hot runs only the hot paths, --json writes their samples and --compare reruns them
+// against a baseline, exiting with 2 when any is significantly slower and 1 on errors
+static int Main(int argc, char* argv[])
+{
+	bool hot = false;
+	std::string json, baseline;
+	double threshold = 0.03;
+	double alpha = 0.01;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--hot")
+			hot = true;
+		else if (arg == "--json" && i + 1 < argc)
+			json = argv[++i];
+		else if (arg == "--compare" && i + 1 < argc)
+			baseline = argv[++i];
+		else if (arg == "--threshold" && i + 1 < argc)
+			threshold = std::atof(argv[++i]);
+		else if (arg == "--alpha" && i + 1 < argc)
+			alpha = std::atof(argv[++i]);
+		else
+		{
+			std::fprintf(stderr, "Usage: Benchmark [--hot] [--json path] [--compare baseline.json [--threshold 0.03] [--alpha 0.01]]\n");
+			return 1;
+		}
+	}
+
+	// Read first so a bad path fails before the long run
+	const Report report = baseline.empty() ? Report{} : Harness::ReadJson(baseline);
+
+	if (!hot && baseline.empty())
+	{
+		BenchmarkKernel();
+		BenchmarkChains();
+		BenchmarkEnsemble();
+		BenchmarkScaling();
+	}
+
+	Harness harness;
+	TagMachine(harness);
+	BenchmarkHotPaths(harness);
+
+	if (!json.empty())
+		harness.WriteJson(json);
+
+	if (baseline.empty())
+		return 0;
+
+	for (const auto& [key, value] : report.tags)
+	{
+		for (const auto& [k, v] : harness.GetTags())
+			if (k == key && v != value)
+				std::printf("Warning: baseline %s is '%s', this run's is '%s'\n", key.c_str(), value.c_str(), v.c_str());
+	}
+
+	const int slower = harness.Compare(report, threshold, alpha);
+
+	if (slower > 0)
+	{
+		std::printf("%d benchmark%s slower than the baseline\n", slower, slower == 1 ? "" : "s");
+		return 2;
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return Main(argc, argv);
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "Error: %s\n", e.what());
+	}
+
+	return 1;
+}